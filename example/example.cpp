@@ -1,3 +1,4 @@
+#include <cmath>
 #include <iostream>
 
 #include <exprcpp.hpp>
@@ -31,6 +32,7 @@ int main()
     symbol_table.add_variable("y", &y);
     symbol_table.add_constants();
     symbol_table.add_function("my_func", &my_func);
+    symbol_table.add_function("hypot", [](double a, double b) { return std::hypot(a, b); });
 
     expression.register_symbol_table(symbol_table);
 
@@ -40,9 +42,14 @@ int main()
         std::cout << ">>> ";
         std::getline(std::cin, string_expression);
 
-        if (exprcpp::compile(string_expression, expression) == EXIT_SUCCESS)
+        exprcpp::compile_error_t error;
+        if (exprcpp::compile(string_expression, expression, error) == EXIT_SUCCESS)
         {
             std::cout << expression.value() << std::endl;
         }
+        else
+        {
+            std::cerr << error.message(string_expression) << std::endl;
+        }
     }
 }
\ No newline at end of file
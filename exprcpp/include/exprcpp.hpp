@@ -1,14 +1,31 @@
 #pragma once
 
+#include "exprcpp/arrow.hpp"
+#include "exprcpp/batch.hpp"
+#include "exprcpp/compile.hpp"
+#include "exprcpp/compile_cache.hpp"
+#include "exprcpp/dependency_index.hpp"
 #include "exprcpp/expression.hpp"
+#include "exprcpp/frame.hpp"
 #include "exprcpp/function.hpp"
+#include "exprcpp/layout.hpp"
 #include "exprcpp/symbol_table.hpp"
+#include "exprcpp/versioned_table.hpp"
 
 namespace exprcpp
 {
 
+	// Nothing is printed on failure, the overloads taking a compile_error_t report where and why
 	template<typename T>
 	auto compile(const std::string& expression_string, expression_t<T>& expression) -> int;
+	template<typename T>
+	auto compile(const std::string& expression_string, expression_t<T>& expression, compile_error_t& error) -> int;
+
+	// Reuses the tree of an earlier compile of the same text, parsing and caching it on a miss
+	template<typename T>
+	auto compile(const std::string& expression_string, expression_t<T>& expression, compile_cache_t& cache) -> int;
+	template<typename T>
+	auto compile(const std::string& expression_string, expression_t<T>& expression, compile_cache_t& cache, compile_error_t& error) -> int;
 
 }
 
@@ -1,20 +1,54 @@
 #include "exprcpp.hpp"
 
-#include <iostream>
-
-#include "exprcpp/parser.hpp"
+#include <cstdlib>
 
 template<typename T>
 auto exprcpp::compile(const std::string& expression_string, expression_t<T>& expression) -> int
 {
-	internal::parser_t parser(expression_string);
-	auto ast = parser.compile();
-	if (!ast)
+	compile_error_t error;
+	return compile(expression_string, expression, error);
+}
+
+template<typename T>
+auto exprcpp::compile(const std::string& expression_string, expression_t<T>& expression, compile_error_t& error) -> int
+{
+	auto result = compile_tree(expression_string);
+	error = result.error;
+	if (!result.ok())
+	{
+		return EXIT_FAILURE;
+	}
+
+	expression.set_ast(std::move(result.tree));
+	return EXIT_SUCCESS;
+}
+
+template<typename T>
+auto exprcpp::compile(const std::string& expression_string, expression_t<T>& expression, compile_cache_t& cache) -> int
+{
+	compile_error_t error;
+	return compile(expression_string, expression, cache, error);
+}
+
+template<typename T>
+auto exprcpp::compile(const std::string& expression_string, expression_t<T>& expression, compile_cache_t& cache, compile_error_t& error) -> int
+{
+	// Trees only hold their own names and are bound to a symbol table when evaluated, so every table shares one entry
+	if (auto tree = cache.find(expression_string))
+	{
+		error = compile_error_t();
+		expression.set_ast(std::move(tree));
+		return EXIT_SUCCESS;
+	}
+
+	auto result = compile_tree(expression_string);
+	error = result.error;
+	if (!result.ok())
 	{
-		std::cerr << "Failed to parse '" << expression_string << "'" << std::endl;
 		return EXIT_FAILURE;
 	}
 
-	expression.set_ast(ast);
+	cache.insert(expression_string, result.tree);
+	expression.set_ast(std::move(result.tree));
 	return EXIT_SUCCESS;
 }
\ No newline at end of file
@@ -0,0 +1,61 @@
+#pragma once
+
+#include "exprcpp/batch.hpp"
+#include <limits>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace exprcpp
+{
+
+	template<typename T>
+	struct accumulator_t
+	{
+		size_t count = 0;
+		T sum = T(0);
+		T compensation = T(0);	// Running error of sum, see Neumaier's variant of Kahan summation
+		T min = std::numeric_limits<T>::max();
+		T max = std::numeric_limits<T>::lowest();
+		std::vector<size_t> histogram;	// Underflow bin, the configured bins, then the overflow bin
+
+		auto total() const -> T;
+		auto mean() const -> T;
+	};
+
+	template<typename T>
+	class aggregator_t
+	{
+	public:
+		aggregator_t() = default;
+		~aggregator_t() = default;
+
+		auto set_histogram(const T& low, const T& high, size_t bins) -> bool;
+		auto set_group_by(const std::string& column) -> void;
+		auto group_by() const -> const std::string&;
+
+		auto groups() const -> size_t;
+		auto key(size_t group) const -> int64_t;
+		auto group(size_t group) const -> const accumulator_t<T>&;
+		auto find(int64_t key) const -> const accumulator_t<T>*;
+
+		auto clear() -> void;
+		auto merge(const aggregator_t& other) -> bool;
+		auto add(const column_t* keys, const uint32_t* selection, size_t begin, size_t count, const T* values, const uint8_t* valid) -> void;
+	private:
+		auto group_index(int64_t key) -> size_t;
+		auto add_value(accumulator_t<T>& accumulator, const T& value) const -> void;
+	private:
+		std::string m_group_by;
+		T m_low = T(0);
+		T m_high = T(0);
+		size_t m_bins = 0;
+
+		std::vector<int64_t> m_keys;
+		std::vector<accumulator_t<T>> m_groups;
+		std::unordered_map<int64_t, size_t> m_index;
+	};
+
+}
+
+#include "aggregate.inl"
\ No newline at end of file
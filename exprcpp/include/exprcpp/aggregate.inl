@@ -0,0 +1,242 @@
+#include "aggregate.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+
+#include "exprcpp/batch_evaluator.hpp"
+
+namespace exprcpp
+{
+
+	namespace internal
+	{
+
+		template<typename T>
+		inline auto neumaier_add(T& sum, T& compensation, const T& value) -> void
+		{
+			const T total = sum + value;
+			if (std::abs(sum) >= std::abs(value))
+			{
+				compensation += (sum - total) + value;
+			}
+			else
+			{
+				compensation += (value - total) + sum;
+			}
+			sum = total;
+		}
+
+		template<typename U>
+		inline auto column_value(const column_t& column, size_t row) -> U
+		{
+			if (column.stride != 0)
+			{
+				return *reinterpret_cast<const U*>(static_cast<const char*>(column.data) + (column.offset + row) * column.stride);
+			}
+			return static_cast<const U*>(column.data)[column.offset + row];
+		}
+
+		inline auto column_key(const column_t& column, size_t row) -> int64_t
+		{
+			switch (column.type)
+			{
+			case column_type_e::float64: return static_cast<int64_t>(column_value<double>(column, row));
+			case column_type_e::float32: return static_cast<int64_t>(column_value<float>(column, row));
+			case column_type_e::int64: return column_value<int64_t>(column, row);
+			}
+			return 0;
+		}
+
+	}
+
+	template<typename T>
+	auto accumulator_t<T>::total() const -> T
+	{
+		return sum + compensation;
+	}
+
+	template<typename T>
+	auto accumulator_t<T>::mean() const -> T
+	{
+		if (count == 0)
+		{
+			return std::numeric_limits<T>::quiet_NaN();
+		}
+		return total() / static_cast<T>(count);
+	}
+
+	template<typename T>
+	auto aggregator_t<T>::set_histogram(const T& low, const T& high, size_t bins) -> bool
+	{
+		if (!(low < high) || bins == 0 || !m_groups.empty())
+		{
+			return false;
+		}
+		m_low = low;
+		m_high = high;
+		m_bins = bins;
+		return true;
+	}
+
+	template<typename T>
+	auto aggregator_t<T>::set_group_by(const std::string& column) -> void
+	{
+		m_group_by = column;
+	}
+
+	template<typename T>
+	auto aggregator_t<T>::group_by() const -> const std::string&
+	{
+		return m_group_by;
+	}
+
+	template<typename T>
+	auto aggregator_t<T>::groups() const -> size_t
+	{
+		return m_groups.size();
+	}
+
+	template<typename T>
+	auto aggregator_t<T>::key(size_t group) const -> int64_t
+	{
+		return m_keys[group];
+	}
+
+	template<typename T>
+	auto aggregator_t<T>::group(size_t group) const -> const accumulator_t<T>&
+	{
+		return m_groups[group];
+	}
+
+	template<typename T>
+	auto aggregator_t<T>::find(int64_t key) const -> const accumulator_t<T>*
+	{
+		auto it = m_index.find(key);
+		if (it == m_index.end())
+		{
+			return nullptr;
+		}
+		return &m_groups[it->second];
+	}
+
+	template<typename T>
+	auto aggregator_t<T>::clear() -> void
+	{
+		m_keys.clear();
+		m_groups.clear();
+		m_index.clear();
+	}
+
+	template<typename T>
+	auto aggregator_t<T>::merge(const aggregator_t& other) -> bool
+	{
+		if (other.m_group_by != m_group_by || other.m_bins != m_bins || other.m_low != m_low || other.m_high != m_high)
+		{
+			return false;
+		}
+
+		for (size_t n = 0; n < other.m_groups.size(); n++)
+		{
+			const auto& from = other.m_groups[n];
+			auto& into = m_groups[group_index(other.m_keys[n])];
+
+			into.count += from.count;
+			internal::neumaier_add(into.sum, into.compensation, from.sum);
+			internal::neumaier_add(into.sum, into.compensation, from.compensation);
+			into.min = std::min(into.min, from.min);
+			into.max = std::max(into.max, from.max);
+			for (size_t bin = 0; bin < from.histogram.size(); bin++)
+			{
+				into.histogram[bin] += from.histogram[bin];
+			}
+		}
+		return true;
+	}
+
+	template<typename T>
+	auto aggregator_t<T>::add(const column_t* keys, const uint32_t* selection, size_t begin, size_t count, const T* values, const uint8_t* valid) -> void
+	{
+		if (keys == nullptr)
+		{
+			auto& accumulator = m_groups[group_index(0)];
+			for (size_t i = 0; i < count; i++)
+			{
+				if (valid[i])
+				{
+					add_value(accumulator, values[i]);
+				}
+			}
+			return;
+		}
+
+		// Keys have a small cardinality and usually come in runs, so remember the last group
+		int64_t last_key = 0;
+		size_t last_group = SIZE_MAX;
+		for (size_t i = 0; i < count; i++)
+		{
+			if (!valid[i])
+			{
+				continue;
+			}
+
+			const size_t row = selection != nullptr ? selection[begin + i] : begin + i;
+			if (keys->validity != nullptr && !internal::bitmap_get(keys->validity, keys->offset + row))
+			{
+				continue;
+			}
+
+			const int64_t key = internal::column_key(*keys, row);
+			if (last_group == SIZE_MAX || key != last_key)
+			{
+				last_key = key;
+				last_group = group_index(key);
+			}
+			add_value(m_groups[last_group], values[i]);
+		}
+	}
+
+	template<typename T>
+	auto aggregator_t<T>::group_index(int64_t key) -> size_t
+	{
+		auto it = m_index.find(key);
+		if (it != m_index.end())
+		{
+			return it->second;
+		}
+
+		accumulator_t<T> accumulator;
+		if (m_bins != 0)
+		{
+			accumulator.histogram.assign(m_bins + 2, 0);
+		}
+		m_index[key] = m_groups.size();
+		m_keys.push_back(key);
+		m_groups.push_back(std::move(accumulator));
+		return m_groups.size() - 1;
+	}
+
+	template<typename T>
+	auto aggregator_t<T>::add_value(accumulator_t<T>& accumulator, const T& value) const -> void
+	{
+		accumulator.count++;
+		internal::neumaier_add(accumulator.sum, accumulator.compensation, value);
+		accumulator.min = std::min(accumulator.min, value);
+		accumulator.max = std::max(accumulator.max, value);
+
+		if (m_bins != 0)
+		{
+			size_t bin = 0;
+			if (value >= m_high)
+			{
+				bin = m_bins + 1;
+			}
+			else if (value >= m_low)
+			{
+				bin = 1 + std::min(m_bins - 1, static_cast<size_t>((value - m_low) * static_cast<T>(m_bins) / (m_high - m_low)));
+			}
+			accumulator.histogram[bin]++;
+		}
+	}
+
+}
\ No newline at end of file
@@ -0,0 +1,62 @@
+#pragma once
+
+#include "exprcpp/batch.hpp"
+#include <cstdint>
+
+// Arrow C data interface, see https://arrow.apache.org/docs/format/CDataInterface.html
+#ifndef ARROW_C_DATA_INTERFACE
+#define ARROW_C_DATA_INTERFACE
+
+#define ARROW_FLAG_DICTIONARY_ORDERED 1
+#define ARROW_FLAG_NULLABLE 2
+#define ARROW_FLAG_MAP_KEYS_SORTED 4
+
+extern "C"
+{
+
+	struct ArrowSchema
+	{
+		const char* format;
+		const char* name;
+		const char* metadata;
+		int64_t flags;
+		int64_t n_children;
+		struct ArrowSchema** children;
+		struct ArrowSchema* dictionary;
+
+		void (*release)(struct ArrowSchema*);
+		void* private_data;
+	};
+
+	struct ArrowArray
+	{
+		int64_t length;
+		int64_t null_count;
+		int64_t offset;
+		int64_t n_buffers;
+		int64_t n_children;
+		const void** buffers;
+		struct ArrowArray** children;
+		struct ArrowArray* dictionary;
+
+		void (*release)(struct ArrowArray*);
+		void* private_data;
+	};
+
+}
+
+#endif
+
+namespace exprcpp::arrow
+{
+
+	auto import_column(const ArrowSchema& schema, const ArrowArray& array, column_t& column) -> bool;
+	auto bind_column(batch_t& batch, const std::string& name, const ArrowSchema& schema, const ArrowArray& array) -> bool;
+	auto bind_record_batch(batch_t& batch, const ArrowSchema& schema, const ArrowArray& array) -> bool;
+
+	template<typename T>
+	auto export_array(batch_result_t<T>&& result, ArrowArray& array, ArrowSchema& schema) -> bool;
+
+}
+
+#include "arrow.inl"
\ No newline at end of file
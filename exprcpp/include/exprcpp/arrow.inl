@@ -0,0 +1,82 @@
+#include "arrow.hpp"
+
+#include <type_traits>
+
+namespace exprcpp::arrow
+{
+
+	namespace internal
+	{
+
+		template<typename T>
+		struct exported_array_t
+		{
+			batch_result_t<T> result;
+			const void* buffers[2];
+		};
+
+		template<typename T>
+		constexpr auto format() -> const char*
+		{
+			if constexpr (std::is_same_v<T, double>)
+			{
+				return "g";
+			}
+			else if constexpr (std::is_same_v<T, float>)
+			{
+				return "f";
+			}
+			else
+			{
+				static_assert(std::is_same_v<T, int64_t>, "exprcpp::arrow: unsupported export type");
+				return "l";
+			}
+		}
+
+		template<typename T>
+		auto release_array(ArrowArray* array) -> void
+		{
+			delete static_cast<exported_array_t<T>*>(array->private_data);
+			array->release = nullptr;
+		}
+
+		inline auto release_schema(ArrowSchema* schema) -> void
+		{
+			schema->release = nullptr;
+		}
+
+	}
+
+	template<typename T>
+	auto export_array(batch_result_t<T>&& result, ArrowArray& array, ArrowSchema& schema) -> bool
+	{
+		// The result buffers are moved into the array, the consumer frees them through release
+		auto exported = new internal::exported_array_t<T>();
+		exported->result = std::move(result);
+		exported->buffers[0] = exported->result.null_count == 0 ? nullptr : exported->result.validity.data();
+		exported->buffers[1] = exported->result.values.data();
+
+		array.length = static_cast<int64_t>(exported->result.values.size());
+		array.null_count = static_cast<int64_t>(exported->result.null_count);
+		array.offset = 0;
+		array.n_buffers = 2;
+		array.n_children = 0;
+		array.buffers = exported->buffers;
+		array.children = nullptr;
+		array.dictionary = nullptr;
+		array.release = &internal::release_array<T>;
+		array.private_data = exported;
+
+		schema.format = internal::format<T>();
+		schema.name = "";
+		schema.metadata = nullptr;
+		schema.flags = ARROW_FLAG_NULLABLE;
+		schema.n_children = 0;
+		schema.children = nullptr;
+		schema.dictionary = nullptr;
+		schema.release = &internal::release_schema;
+		schema.private_data = nullptr;
+		return true;
+	}
+
+}
\ No newline at end of file
@@ -1,52 +1,49 @@
 #pragma once
 
-#include <memory>
+#include <cstdint>
+#include <span>
 #include <string>
+#include <string_view>
+#include <unordered_map>
 #include <variant>
 #include <vector>
 
+#include "exprcpp/interner.hpp"
+
 namespace exprcpp::internal::ast
 {
-	
-	struct node_t {};
-	struct statement_t;
-	struct expression_t;
 
-	typedef std::shared_ptr<node_t> node_ptr_t;
-	typedef std::shared_ptr<statement_t> stmt_ptr_t;
-	typedef std::shared_ptr<expression_t> expr_ptr_t;
+	// Nodes refer to each other by their position in the tree, position 0 stands for a missing node
+	typedef uint32_t stmt_id_t;
+	typedef uint32_t expr_id_t;
+	const uint32_t null_id = 0;
 
-	template<typename T>
-	struct sequence_t
+	// Children stored back to back in the tree's list array
+	struct range_t
 	{
-		std::vector<T> elements;
+		uint32_t first = 0;
+		uint32_t count = 0;
 	};
 
-	typedef sequence_t<node_ptr_t> generic_seq_t;
-	typedef sequence_t<stmt_ptr_t> stmt_seq_t;
-	typedef sequence_t<expr_ptr_t> expr_seq_t;
-
-	typedef std::shared_ptr<generic_seq_t> generic_seq_ptr_t;
-	typedef std::shared_ptr<stmt_seq_t> stmt_seq_ptr_t;
-	typedef std::shared_ptr<expr_seq_t> expr_seq_ptr_t;
+	typedef std::vector<expr_id_t> expr_seq_t;
 
 	enum class statement_kind_e
 	{
 		if_else, expr
 	};
 
-	struct statement_t : node_t
+	struct statement_t
 	{
 		struct stmt_if_else_t
 		{
-			expr_ptr_t condition;
-			expr_ptr_t true_case;
-			expr_ptr_t false_case;
+			expr_id_t condition;
+			expr_id_t true_case;
+			expr_id_t false_case;
 		};
 
 		struct stmt_expr_t
 		{
-			expr_ptr_t value;
+			expr_id_t value;
 		};
 
 		statement_kind_e kind;
@@ -104,67 +101,67 @@ namespace exprcpp::internal::ast
 		slice
 	};
 
-	struct expression_t : node_t
+	struct expression_t
 	{
 		struct expr_bool_op_t
 		{
 			bool_op_type_e op;
-			expr_seq_ptr_t values;
+			range_t values;
 		};
 
 		struct expr_bin_op_t
 		{
-			expr_ptr_t left;
+			expr_id_t left;
 			operator_type_e op;
-			expr_ptr_t right;
+			expr_id_t right;
 		};
 
 		struct expr_unary_op_t
 		{
 			unary_op_type_e op;
-			expr_ptr_t right;
+			expr_id_t right;
 		};
 
 		struct expr_cmp_op_t
 		{
-			expr_ptr_t left;
+			expr_id_t left;
 			cmp_op_type_e op;
-			expr_ptr_t right;
+			expr_id_t right;
 		};
 
 		struct expr_assign_t
 		{
-			std::string id;
-			expr_ptr_t value;
+			string_id_t id;
+			expr_id_t value;
 		};
 
 		struct expr_constant_t
 		{
-			std::string value;
+			uint32_t value;
 		};
 
 		struct expr_name_t
 		{
-			std::string id;
+			string_id_t id;
 			expr_context_type_e context;
 		};
 
 		struct expr_vector_t
 		{
-			expr_seq_ptr_t elements;
+			range_t elements;
 		};
 
 		struct expr_call_t
 		{
-			std::string name;
-			expr_seq_ptr_t args;
+			string_id_t name;
+			range_t args;
 		};
 
 		struct expr_slice_t
 		{
-			expr_ptr_t vector;
-			expr_ptr_t start;
-			expr_ptr_t stop;
+			expr_id_t vector;
+			expr_id_t start;
+			expr_id_t stop;
 		};
 
 		expression_kind_e kind;
@@ -172,16 +169,56 @@ namespace exprcpp::internal::ast
 					 expr_constant_t, expr_name_t, expr_vector_t, expr_call_t, expr_slice_t> value;
 	};
 
-	auto if_else(const expr_ptr_t& condition, const expr_ptr_t& true_case, const expr_ptr_t& false_case) -> stmt_ptr_t;
-	auto expression(const expr_ptr_t& expr) -> stmt_ptr_t;
-	auto bool_op(bool_op_type_e op, const expr_seq_ptr_t& values) -> expr_ptr_t;
-	auto bin_op(const expr_ptr_t& left, operator_type_e op, const expr_ptr_t& right) -> expr_ptr_t;
-	auto unary_op(unary_op_type_e op, const expr_ptr_t& right) -> expr_ptr_t;
-	auto cmp_op(const expr_ptr_t& left, cmp_op_type_e op, const expr_ptr_t& right) -> expr_ptr_t;
-	auto assign(const std::string& id, const expr_ptr_t& value) -> expr_ptr_t;
-	auto constant(const std::string& value) -> expr_ptr_t;
-	auto name(const std::string& id, expr_context_type_e context) -> expr_ptr_t;
-	auto vector(const expr_seq_ptr_t& elements) -> expr_ptr_t;
-	auto call(const std::string& name, const expr_seq_ptr_t& args) -> expr_ptr_t;
-	auto slice(const expr_ptr_t& vector, const expr_ptr_t& start, const expr_ptr_t& stop) -> expr_ptr_t;
+	// Owns every node of one compiled expression in a few flat arrays
+	class tree_t
+	{
+	public:
+		tree_t();
+		tree_t(const tree_t&) = default;
+		tree_t(tree_t&&) noexcept = default;
+		~tree_t() = default;
+
+		auto operator=(const tree_t&) -> tree_t& = default;
+		auto operator=(tree_t&&) noexcept -> tree_t& = default;
+
+		auto reserve(size_t expressions) -> void;
+		auto empty() const -> bool;
+		auto size() const -> size_t;
+		auto statements() const -> const std::vector<stmt_id_t>&;
+		auto set_statements(std::vector<stmt_id_t> statements) -> void;
+
+		auto get_statement(stmt_id_t id) const -> const statement_t&;
+		auto get_expression(expr_id_t id) const -> const expression_t&;
+		auto get_list(const range_t& range) const -> std::span<const expr_id_t>;
+		auto get_name(string_id_t id) const -> const std::string&;
+		auto names() const -> const std::vector<std::string>&;
+		auto get_constant(uint32_t id) const -> const std::string&;
+
+		auto if_else(expr_id_t condition, expr_id_t true_case, expr_id_t false_case) -> stmt_id_t;
+		auto expression(expr_id_t expr) -> stmt_id_t;
+		auto bool_op(bool_op_type_e op, const range_t& values) -> expr_id_t;
+		auto bin_op(expr_id_t left, operator_type_e op, expr_id_t right) -> expr_id_t;
+		auto unary_op(unary_op_type_e op, expr_id_t right) -> expr_id_t;
+		auto cmp_op(expr_id_t left, cmp_op_type_e op, expr_id_t right) -> expr_id_t;
+		auto assign(std::string_view id, expr_id_t value) -> expr_id_t;
+		auto constant(std::string_view value) -> expr_id_t;
+		auto name(std::string_view id, expr_context_type_e context) -> expr_id_t;
+		auto vector(const range_t& elements) -> expr_id_t;
+		auto call(std::string_view name, const range_t& args) -> expr_id_t;
+		auto slice(expr_id_t vector, expr_id_t start, expr_id_t stop) -> expr_id_t;
+		auto list(const expr_id_t* elements, size_t count) -> range_t;
+	private:
+		auto add(expression_kind_e kind, const decltype(expression_t::value)& value) -> expr_id_t;
+		auto add_name(std::string_view name) -> string_id_t;
+	private:
+		std::vector<statement_t> m_statements;
+		std::vector<expression_t> m_expressions;
+		std::vector<expr_id_t> m_lists;
+		std::vector<stmt_id_t> m_root;
+		std::vector<std::string> m_constants;
+		// Names are numbered per tree, tables and batches map them to their own ids when bound, so parsing interns nothing
+		std::vector<std::string> m_names;
+		std::unordered_map<std::string, string_id_t> m_name_ids;
+	};
+
 }
\ No newline at end of file
@@ -0,0 +1,67 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "exprcpp/interner.hpp"
+
+namespace exprcpp
+{
+
+	enum class column_type_e
+	{
+		float64, float32, int64
+	};
+
+	struct column_t
+	{
+		column_type_e type = column_type_e::float64;
+		const void* data = nullptr;
+		const uint8_t* validity = nullptr;	// LSB ordered bitmap, nullptr when every row is valid
+		size_t offset = 0;					// Element offset applied to both data and validity
+		size_t length = 0;
+		size_t stride = 0;					// Bytes from one row to the next, 0 when the values are packed
+	};
+
+	typedef std::vector<uint32_t> selection_t;	// Ascending indices of the rows a filter kept
+
+	template<typename T>
+	struct batch_result_t
+	{
+		std::vector<T> values;
+		std::vector<uint8_t> validity;		// LSB ordered bitmap, empty when null_count is 0
+		size_t null_count = 0;
+	};
+
+	class batch_t
+	{
+	public:
+		explicit batch_t(size_t rows);
+		~batch_t() = default;
+
+		auto rows() const -> size_t;
+
+		// Rows evaluated per tile, 0 sizes tiles from the expression so they stay cache resident
+		auto set_tile_size(size_t rows) -> void;
+		auto tile_size() const -> size_t;
+
+		auto add_column(const std::string& name, const column_t& column) -> bool;
+		auto add_column(const std::string& name, const double* data, const uint8_t* validity = nullptr) -> bool;
+		auto add_column(const std::string& name, const float* data, const uint8_t* validity = nullptr) -> bool;
+		auto add_column(const std::string& name, const int64_t* data, const uint8_t* validity = nullptr) -> bool;
+
+		auto slice(size_t begin, size_t rows) const -> batch_t;
+
+		auto has_column(const std::string& name) const -> bool;
+		auto get_column(const std::string& name) const -> const column_t*;
+		auto get_column(internal::string_id_t name) const -> const column_t*;
+	private:
+		size_t m_rows;
+		size_t m_tile_size = 0;
+		std::unordered_map<internal::string_id_t, column_t> m_columns;
+		internal::string_refs_t m_names;	// Keeps the column ids from being reused while the batch has them
+	};
+
+}
\ No newline at end of file
@@ -0,0 +1,115 @@
+#pragma once
+
+#include "exprcpp/ast.hpp"
+#include "exprcpp/batch.hpp"
+#include "exprcpp/symbol_table.hpp"
+
+namespace exprcpp::internal
+{
+
+	namespace constants
+	{
+		const size_t tile_cache_budget = 128 * 1024;	// Bytes of scratch a tile may touch, about half a typical L2
+		const size_t tile_min_rows = 64;
+		const size_t tile_max_rows = 4096;
+	}
+
+	template<typename T>
+	class scratch_arena_t
+	{
+	public:
+		auto reset(size_t slots, size_t slot_size) -> void;
+
+		auto acquire(size_t count = 1) -> T*;
+		auto release(size_t count = 1) -> void;
+	private:
+		std::vector<T> m_buffer;
+		size_t m_slot_size = 0;
+		size_t m_slots = 0;
+		size_t m_top = 0;
+	};
+
+	template<typename T>
+	struct scratch_t
+	{
+		scratch_t(scratch_arena_t<T>& arena, size_t count = 1);
+		~scratch_t();
+
+		scratch_arena_t<T>& arena;
+		size_t count;
+		T* data;
+	};
+
+	template<typename T>
+	struct tile_t
+	{
+		size_t begin = 0;				// Position of the first row in the batch or selection
+		size_t count = 0;
+		const T* values = nullptr;
+		const uint8_t* valid = nullptr;	// One byte per row, 0 when an input was null
+	};
+
+	template<typename T>
+	auto store_nulls(const tile_t<T>& tile, batch_result_t<T>& result) -> void;
+
+	template<typename T>
+	class batch_evaluator_t
+	{
+	public:
+		batch_evaluator_t(symbol_table_t<T>& symbol_table, const batch_t& batch);
+		~batch_evaluator_t() = default;
+
+		auto evaluate(const ast::tree_t& ast, batch_result_t<T>& result) -> bool;
+		auto evaluate(const ast::tree_t& ast, const selection_t& selection, batch_result_t<T>& result) -> bool;
+		auto filter(const ast::tree_t& ast, selection_t& selection) -> bool;
+		auto filter(const ast::tree_t& ast, std::vector<uint8_t>& bitmap) -> bool;
+
+		auto start(const ast::tree_t& ast, const uint32_t* selection, size_t rows) -> bool;
+		auto next_tile(tile_t<T>& tile, T* out) -> bool;
+		auto failed() const -> bool;
+	private:
+		auto evaluate(const ast::tree_t& ast, const uint32_t* selection, size_t rows, batch_result_t<T>& result) -> bool;
+
+		auto evaluate_statement(ast::stmt_id_t statement, T* out) -> bool;
+		auto evaluate_expression(ast::expr_id_t expression, T* out) -> bool;
+		auto evaluate_bool_op(ast::bool_op_type_e op, const ast::range_t& values, T* out) -> bool;
+		auto evaluate_bin_op(ast::expr_id_t left, ast::operator_type_e op, ast::expr_id_t right, T* out) -> bool;
+		auto evaluate_unary_op(ast::unary_op_type_e op, ast::expr_id_t right, T* out) -> bool;
+		auto evaluate_cmp_op(ast::expr_id_t left, ast::cmp_op_type_e op, ast::expr_id_t right, T* out) -> bool;
+		auto evaluate_in(ast::expr_id_t left, ast::expr_id_t right, bool negate, T* out) -> bool;
+		auto evaluate_constant(const std::string& value, T* out) -> bool;
+		auto evaluate_name(string_id_t id, T* out) -> bool;
+		auto evaluate_call(string_id_t name, const ast::range_t& args, T* out) -> bool;
+
+		template<typename U>
+		auto gather(const column_t& column, T* out) const -> void;
+		auto load_column(const column_t& column, T* out) -> void;
+		auto prefetch_columns(size_t begin, size_t count) const -> void;
+
+		auto statement_slots(ast::stmt_id_t statement) -> size_t;
+		auto expression_slots(ast::expr_id_t expression) -> size_t;
+		auto tile_size(size_t slots) const -> size_t;
+	private:
+		symbol_table_t<T>& m_symbol_table;
+		const batch_t& m_batch;
+
+		const ast::tree_t* m_ast = nullptr;
+		std::vector<string_id_t> m_ids;	// The batch's and table's id for each name the tree numbers
+		const uint32_t* m_selection = nullptr;
+		size_t m_rows = 0;
+		size_t m_next = 0;
+		size_t m_tile_rows = 0;
+		bool m_failed = false;
+
+		size_t m_begin = 0;
+		size_t m_count = 0;
+		std::vector<uint8_t> m_valid;
+
+		scratch_arena_t<T> m_arena;
+		T* m_output = nullptr;
+		std::vector<const column_t*> m_columns;
+	};
+
+}
+
+#include "batch_evaluator.inl"
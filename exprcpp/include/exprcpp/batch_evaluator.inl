@@ -0,0 +1,771 @@
+#include "batch_evaluator.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#include <xmmintrin.h>
+#define EXPRCPP_PREFETCH(address) _mm_prefetch(reinterpret_cast<const char*>(address), _MM_HINT_T1)
+#elif defined(__GNUC__)
+#define EXPRCPP_PREFETCH(address) __builtin_prefetch(address, 0, 2)
+#else
+#define EXPRCPP_PREFETCH(address)
+#endif
+
+#include "exprcpp/convert.hpp"
+
+namespace exprcpp::internal
+{
+
+	inline auto bitmap_get(const uint8_t* bitmap, size_t index) -> bool
+	{
+		return (bitmap[index >> 3] >> (index & 7)) & 1;
+	}
+
+	inline auto bitmap_set(uint8_t* bitmap, size_t index, bool value) -> void
+	{
+		if (value)
+		{
+			bitmap[index >> 3] |= uint8_t(1 << (index & 7));
+		}
+		else
+		{
+			bitmap[index >> 3] &= uint8_t(~(1 << (index & 7)));
+		}
+	}
+
+	template<typename T>
+	auto scratch_arena_t<T>::reset(size_t slots, size_t slot_size) -> void
+	{
+		if (m_buffer.size() < slots * slot_size)
+		{
+			m_buffer.resize(slots * slot_size);
+		}
+		m_slots = slots;
+		m_slot_size = slot_size;
+		m_top = 0;
+	}
+
+	template<typename T>
+	auto scratch_arena_t<T>::acquire(size_t count) -> T*
+	{
+		if (m_top + count > m_slots)
+		{
+			return nullptr;
+		}
+		auto data = m_buffer.data() + m_top * m_slot_size;
+		m_top += count;
+		return data;
+	}
+
+	template<typename T>
+	auto scratch_arena_t<T>::release(size_t count) -> void
+	{
+		m_top -= std::min(count, m_top);
+	}
+
+	template<typename T>
+	scratch_t<T>::scratch_t(scratch_arena_t<T>& arena, size_t count)
+		: arena(arena), count(count), data(arena.acquire(count))
+	{ }
+
+	template<typename T>
+	scratch_t<T>::~scratch_t()
+	{
+		if (data != nullptr)
+		{
+			arena.release(count);
+		}
+	}
+
+	template<typename T>
+	auto store_nulls(const tile_t<T>& tile, batch_result_t<T>& result) -> void
+	{
+		for (size_t i = 0; i < tile.count; i++)
+		{
+			if (!tile.valid[i])
+			{
+				if (result.null_count++ == 0)
+				{
+					result.validity.assign((result.values.size() + 7) / 8, 0xFF);
+				}
+				bitmap_set(result.validity.data(), tile.begin + i, false);
+				result.values[tile.begin + i] = T();
+			}
+		}
+	}
+
+	template<typename T>
+	batch_evaluator_t<T>::batch_evaluator_t(symbol_table_t<T>& symbol_table, const batch_t& batch)
+		: m_symbol_table(symbol_table), m_batch(batch)
+	{ }
+
+	template<typename T>
+	auto batch_evaluator_t<T>::evaluate(const ast::tree_t& ast, batch_result_t<T>& result) -> bool
+	{
+		return evaluate(ast, nullptr, m_batch.rows(), result);
+	}
+
+	template<typename T>
+	auto batch_evaluator_t<T>::evaluate(const ast::tree_t& ast, const selection_t& selection, batch_result_t<T>& result) -> bool
+	{
+		return evaluate(ast, selection.data(), selection.size(), result);
+	}
+
+	template<typename T>
+	auto batch_evaluator_t<T>::evaluate(const ast::tree_t& ast, const uint32_t* selection, size_t rows, batch_result_t<T>& result) -> bool
+	{
+		result.values.assign(rows, T());
+		result.null_count = 0;
+		result.validity.clear();
+
+		if (!start(ast, selection, rows))
+		{
+			return false;
+		}
+
+		tile_t<T> tile;
+		while (next_tile(tile, result.values.data()))
+		{
+			store_nulls(tile, result);
+		}
+		return !m_failed;
+	}
+
+	template<typename T>
+	auto batch_evaluator_t<T>::filter(const ast::tree_t& ast, selection_t& selection) -> bool
+	{
+		selection.clear();
+		if (!start(ast, nullptr, m_batch.rows()))
+		{
+			return false;
+		}
+
+		tile_t<T> tile;
+		while (next_tile(tile, nullptr))
+		{
+			for (size_t i = 0; i < tile.count; i++)
+			{
+				if (tile.valid[i] && tile.values[i] != T(0))
+				{
+					selection.push_back(static_cast<uint32_t>(tile.begin + i));
+				}
+			}
+		}
+		return !m_failed;
+	}
+
+	template<typename T>
+	auto batch_evaluator_t<T>::filter(const ast::tree_t& ast, std::vector<uint8_t>& bitmap) -> bool
+	{
+		const size_t rows = m_batch.rows();
+		bitmap.assign((rows + 7) / 8, 0);
+		if (!start(ast, nullptr, rows))
+		{
+			return false;
+		}
+
+		tile_t<T> tile;
+		while (next_tile(tile, nullptr))
+		{
+			for (size_t i = 0; i < tile.count; i++)
+			{
+				if (tile.valid[i] && tile.values[i] != T(0))
+				{
+					bitmap_set(bitmap.data(), tile.begin + i, true);
+				}
+			}
+		}
+		return !m_failed;
+	}
+
+	template<typename T>
+	auto batch_evaluator_t<T>::start(const ast::tree_t& ast, const uint32_t* selection, size_t rows) -> bool
+	{
+		m_ast = &ast;
+		m_selection = selection;
+		m_rows = rows;
+		m_next = 0;
+		// Selections are ascending, so the last row is enough to tell one taken from a larger batch
+		m_failed = ast.empty() || (selection != nullptr ? rows != 0 && selection[rows - 1] >= m_batch.rows() : rows > m_batch.rows());
+		if (m_failed)
+		{
+			return false;
+		}
+
+		m_ids.clear();
+		for (const auto& name : ast.names())
+		{
+			m_ids.push_back(global_interner().find(name));
+		}
+
+		// Every intermediate result of a tile lives in the arena, sized once for the whole batch.
+		// The extra slot holds the tile output when the caller does not provide one.
+		size_t slots = 0;
+		m_columns.clear();
+		for (const auto statement : ast.statements())
+		{
+			slots = std::max(slots, statement_slots(statement));
+		}
+
+		m_tile_rows = tile_size(slots + 1);
+		m_arena.reset(slots + 1, m_tile_rows);
+		m_output = m_arena.acquire();
+		m_valid.resize(m_tile_rows);
+		return true;
+	}
+
+	template<typename T>
+	auto batch_evaluator_t<T>::next_tile(tile_t<T>& tile, T* out) -> bool
+	{
+		if (m_failed || m_next >= m_rows)
+		{
+			return false;
+		}
+
+		m_begin = m_next;
+		m_count = std::min(m_tile_rows, m_rows - m_begin);
+		m_next = m_begin + m_count;
+		std::fill(m_valid.begin(), m_valid.begin() + m_count, uint8_t(1));
+		prefetch_columns(m_next, std::min(m_tile_rows, m_rows - m_next));
+
+		T* values = out != nullptr ? out + m_begin : m_output;
+		for (const auto statement : m_ast->statements())
+		{
+			if (!evaluate_statement(statement, values))
+			{
+				m_failed = true;
+				return false;
+			}
+		}
+
+		tile.begin = m_begin;
+		tile.count = m_count;
+		tile.values = values;
+		tile.valid = m_valid.data();
+		return true;
+	}
+
+	template<typename T>
+	auto batch_evaluator_t<T>::failed() const -> bool
+	{
+		return m_failed;
+	}
+
+	template<typename T>
+	auto batch_evaluator_t<T>::evaluate_statement(ast::stmt_id_t statement, T* out) -> bool
+	{
+		if (statement == ast::null_id)
+		{
+			return false;
+		}
+
+		const auto& node = m_ast->get_statement(statement);
+		switch (node.kind)
+		{
+		case ast::statement_kind_e::if_else:
+		{
+			const auto& if_else = std::get<ast::statement_t::stmt_if_else_t>(node.value);
+			scratch_t<T> condition(m_arena);
+			if (!evaluate_expression(if_else.condition, condition.data) || !evaluate_expression(if_else.true_case, out))
+			{
+				return false;
+			}
+
+			scratch_t<T> false_case(m_arena);
+			if (if_else.false_case == ast::null_id)
+			{
+				std::fill(false_case.data, false_case.data + m_count, T());
+			}
+			else if (!evaluate_expression(if_else.false_case, false_case.data))
+			{
+				return false;
+			}
+
+			for (size_t i = 0; i < m_count; i++)
+			{
+				if (condition.data[i] == T(0))
+				{
+					out[i] = false_case.data[i];
+				}
+			}
+			return true;
+		}
+		case ast::statement_kind_e::expr:
+		{
+			const auto& expr = std::get<ast::statement_t::stmt_expr_t>(node.value);
+			return evaluate_expression(expr.value, out);
+		}
+		}
+
+		return false;
+	}
+
+	template<typename T>
+	auto batch_evaluator_t<T>::evaluate_expression(ast::expr_id_t expression, T* out) -> bool
+	{
+		if (expression == ast::null_id)
+		{
+			return false;
+		}
+
+		const auto& node = m_ast->get_expression(expression);
+		switch (node.kind)
+		{
+		case ast::expression_kind_e::bool_op:
+		{
+			const auto& bool_op = std::get<ast::expression_t::expr_bool_op_t>(node.value);
+			return evaluate_bool_op(bool_op.op, bool_op.values, out);
+		}
+		case ast::expression_kind_e::bin_op:
+		{
+			const auto& bin_op = std::get<ast::expression_t::expr_bin_op_t>(node.value);
+			return evaluate_bin_op(bin_op.left, bin_op.op, bin_op.right, out);
+		}
+		case ast::expression_kind_e::unary_op:
+		{
+			const auto& unary_op = std::get<ast::expression_t::expr_unary_op_t>(node.value);
+			return evaluate_unary_op(unary_op.op, unary_op.right, out);
+		}
+		case ast::expression_kind_e::cmp_op:
+		{
+			const auto& cmp_op = std::get<ast::expression_t::expr_cmp_op_t>(node.value);
+			return evaluate_cmp_op(cmp_op.left, cmp_op.op, cmp_op.right, out);
+		}
+		case ast::expression_kind_e::constant:
+		{
+			const auto& constant = std::get<ast::expression_t::expr_constant_t>(node.value);
+			return evaluate_constant(m_ast->get_constant(constant.value), out);
+		}
+		case ast::expression_kind_e::name:
+		{
+			const auto& name = std::get<ast::expression_t::expr_name_t>(node.value);
+			return evaluate_name(m_ids[name.id], out);
+		}
+		case ast::expression_kind_e::call:
+		{
+			const auto& call = std::get<ast::expression_t::expr_call_t>(node.value);
+			return evaluate_call(m_ids[call.name], call.args, out);
+		}
+		// Assignments, vectors and slices have no per-row meaning
+		case ast::expression_kind_e::assign:
+		case ast::expression_kind_e::vector:
+		case ast::expression_kind_e::slice:
+			return false;
+		}
+
+		return false;
+	}
+
+	template<typename T>
+	auto batch_evaluator_t<T>::evaluate_bool_op(ast::bool_op_type_e op, const ast::range_t& values, T* out) -> bool
+	{
+		const auto elements = m_ast->get_list(values);
+		if (elements.empty() || !evaluate_expression(elements[0], out))
+		{
+			return false;
+		}
+
+		scratch_t<T> value(m_arena);
+		for (size_t n = 1; n < elements.size(); n++)
+		{
+			if (!evaluate_expression(elements[n], value.data))
+			{
+				return false;
+			}
+
+			switch (op)
+			{
+			case ast::bool_op_type_e::And:
+				for (size_t i = 0; i < m_count; i++) out[i] = T(out[i] && value.data[i]);
+				break;
+			case ast::bool_op_type_e::Or:
+				for (size_t i = 0; i < m_count; i++) out[i] = T(out[i] || value.data[i]);
+				break;
+			}
+		}
+		return true;
+	}
+
+	template<typename T>
+	auto batch_evaluator_t<T>::evaluate_bin_op(ast::expr_id_t left, ast::operator_type_e op, ast::expr_id_t right, T* out) -> bool
+	{
+		if (!evaluate_expression(left, out))
+		{
+			return false;
+		}
+
+		scratch_t<T> right_value(m_arena);
+		const T* rhs = right_value.data;
+		if (!evaluate_expression(right, right_value.data))
+		{
+			return false;
+		}
+
+		switch (op)
+		{
+		case ast::operator_type_e::add: for (size_t i = 0; i < m_count; i++) out[i] = out[i] + rhs[i]; return true;
+		case ast::operator_type_e::sub: for (size_t i = 0; i < m_count; i++) out[i] = out[i] - rhs[i]; return true;
+		case ast::operator_type_e::mult: for (size_t i = 0; i < m_count; i++) out[i] = out[i] * rhs[i]; return true;
+		case ast::operator_type_e::div: for (size_t i = 0; i < m_count; i++) out[i] = out[i] / rhs[i]; return true;
+		case ast::operator_type_e::mod: for (size_t i = 0; i < m_count; i++) out[i] = T(std::fmod(out[i], rhs[i])); return true;
+		case ast::operator_type_e::pow: for (size_t i = 0; i < m_count; i++) out[i] = T(std::pow(out[i], rhs[i])); return true;
+		}
+
+		return false;
+	}
+
+	template<typename T>
+	auto batch_evaluator_t<T>::evaluate_unary_op(ast::unary_op_type_e op, ast::expr_id_t right, T* out) -> bool
+	{
+		if (!evaluate_expression(right, out))
+		{
+			return false;
+		}
+
+		switch (op)
+		{
+		case ast::unary_op_type_e::invert: for (size_t i = 0; i < m_count; i++) out[i] = static_cast<T>(~static_cast<uint64_t>(out[i])); return true;
+		case ast::unary_op_type_e::Not: for (size_t i = 0; i < m_count; i++) out[i] = T(!out[i]); return true;
+		case ast::unary_op_type_e::add: return true;
+		case ast::unary_op_type_e::sub: for (size_t i = 0; i < m_count; i++) out[i] = -out[i]; return true;
+		}
+
+		return false;
+	}
+
+	template<typename T>
+	auto batch_evaluator_t<T>::evaluate_cmp_op(ast::expr_id_t left, ast::cmp_op_type_e op, ast::expr_id_t right, T* out) -> bool
+	{
+		switch (op)
+		{
+		case ast::cmp_op_type_e::in: return evaluate_in(left, right, false, out);
+		case ast::cmp_op_type_e::not_in: return evaluate_in(left, right, true, out);
+		default: break;
+		}
+
+		if (!evaluate_expression(left, out))
+		{
+			return false;
+		}
+
+		scratch_t<T> right_value(m_arena);
+		const T* rhs = right_value.data;
+		if (!evaluate_expression(right, right_value.data))
+		{
+			return false;
+		}
+
+		switch (op)
+		{
+		case ast::cmp_op_type_e::eq: for (size_t i = 0; i < m_count; i++) out[i] = T(out[i] == rhs[i]); return true;
+		case ast::cmp_op_type_e::Not_eq: for (size_t i = 0; i < m_count; i++) out[i] = T(out[i] != rhs[i]); return true;
+		case ast::cmp_op_type_e::lt: for (size_t i = 0; i < m_count; i++) out[i] = T(out[i] < rhs[i]); return true;
+		case ast::cmp_op_type_e::lt_eq: for (size_t i = 0; i < m_count; i++) out[i] = T(out[i] <= rhs[i]); return true;
+		case ast::cmp_op_type_e::gt: for (size_t i = 0; i < m_count; i++) out[i] = T(out[i] > rhs[i]); return true;
+		case ast::cmp_op_type_e::gt_eq: for (size_t i = 0; i < m_count; i++) out[i] = T(out[i] >= rhs[i]); return true;
+		default: break;
+		}
+
+		return false;
+	}
+
+	template<typename T>
+	auto batch_evaluator_t<T>::evaluate_in(ast::expr_id_t left, ast::expr_id_t right, bool negate, T* out) -> bool
+	{
+		if (right == ast::null_id || m_ast->get_expression(right).kind != ast::expression_kind_e::vector)
+		{
+			return false;
+		}
+
+		const auto& vector = std::get<ast::expression_t::expr_vector_t>(m_ast->get_expression(right).value);
+		if (vector.elements.count == 0 || !evaluate_expression(left, out))
+		{
+			return false;
+		}
+
+		scratch_t<T> scratch(m_arena, 2);
+		T* count = scratch.data;
+		T* element = scratch.data + m_count;
+		std::fill(count, count + m_count, T(0));
+		for (const auto expr : m_ast->get_list(vector.elements))
+		{
+			if (!evaluate_expression(expr, element))
+			{
+				return false;
+			}
+			for (size_t i = 0; i < m_count; i++)
+			{
+				count[i] += T(out[i] == element[i]);
+			}
+		}
+
+		for (size_t i = 0; i < m_count; i++)
+		{
+			out[i] = negate ? T(count[i] == T(0)) : count[i];
+		}
+		return true;
+	}
+
+	template<typename T>
+	auto batch_evaluator_t<T>::evaluate_constant(const std::string& value, T* out) -> bool
+	{
+		std::fill(out, out + m_count, to_number<T>(value));
+		return true;
+	}
+
+	template<typename T>
+	auto batch_evaluator_t<T>::evaluate_name(string_id_t id, T* out) -> bool
+	{
+		if (const auto column = m_batch.get_column(id))
+		{
+			load_column(*column, out);
+			return true;
+		}
+
+		const auto value = m_symbol_table.resolve(id);
+		if (value == nullptr)
+		{
+			return false;
+		}
+		std::fill(out, out + m_count, *value);
+		return true;
+	}
+
+	template<typename T>
+	auto batch_evaluator_t<T>::evaluate_call(string_id_t name, const ast::range_t& args, T* out) -> bool
+	{
+		auto func = m_symbol_table.get_function(name);
+		if (func == nullptr)
+		{
+			return false;
+		}
+		const size_t num_args = args.count;
+		if (num_args != 0 && !func->accepts(num_args))
+		{
+			return false;
+		}
+
+		// Argument columns sit back to back in the arena, one tile stride apart
+		scratch_t<T> scratch(m_arena, num_args);
+		for (size_t n = 0; n < num_args; n++)
+		{
+			if (!evaluate_expression(m_ast->get_list(args)[n], scratch.data + n * m_count))
+			{
+				return false;
+			}
+		}
+
+		// Then each row's arguments are laid side by side, the way a call takes them
+		scratch_t<T> rows(m_arena, num_args);
+		for (size_t n = 0; n < num_args; n++)
+		{
+			const T* column = scratch.data + n * m_count;
+			for (size_t i = 0; i < m_count; i++)
+			{
+				rows.data[i * num_args + n] = column[i];
+			}
+		}
+		for (size_t i = 0; i < m_count; i++)
+		{
+			out[i] = func->invoke(std::span<const T>(rows.data + i * num_args, num_args));
+		}
+		return true;
+	}
+
+	template<typename T>
+	template<typename U>
+	auto batch_evaluator_t<T>::gather(const column_t& column, T* out) const -> void
+	{
+		if (column.stride != 0 && column.stride != sizeof(U))
+		{ // A field of an array of structs, one value every stride bytes
+			const auto base = static_cast<const char*>(column.data) + column.offset * column.stride;
+			const auto at = [&](size_t row) { return static_cast<T>(*reinterpret_cast<const U*>(base + row * column.stride)); };
+			if (m_selection != nullptr)
+			{
+				const auto rows = m_selection + m_begin;
+				for (size_t i = 0; i < m_count; i++) out[i] = at(rows[i]);
+			}
+			else
+			{
+				for (size_t i = 0; i < m_count; i++) out[i] = at(m_begin + i);
+			}
+			return;
+		}
+
+		const auto data = static_cast<const U*>(column.data) + column.offset;
+		if (m_selection != nullptr)
+		{
+			const auto rows = m_selection + m_begin;
+			for (size_t i = 0; i < m_count; i++) out[i] = static_cast<T>(data[rows[i]]);
+		}
+		else if constexpr (std::is_same_v<T, U>)
+		{
+			std::memcpy(out, data + m_begin, m_count * sizeof(T));
+		}
+		else
+		{
+			for (size_t i = 0; i < m_count; i++) out[i] = static_cast<T>(data[m_begin + i]);
+		}
+	}
+
+	template<typename T>
+	auto batch_evaluator_t<T>::load_column(const column_t& column, T* out) -> void
+	{
+		switch (column.type)
+		{
+		case column_type_e::float64: gather<double>(column, out); break;
+		case column_type_e::float32: gather<float>(column, out); break;
+		case column_type_e::int64: gather<int64_t>(column, out); break;
+		}
+
+		if (column.validity != nullptr)
+		{
+			for (size_t i = 0; i < m_count; i++)
+			{
+				const size_t row = m_selection != nullptr ? m_selection[m_begin + i] : m_begin + i;
+				m_valid[i] &= uint8_t(bitmap_get(column.validity, column.offset + row));
+			}
+		}
+	}
+
+	template<typename T>
+	auto batch_evaluator_t<T>::prefetch_columns(size_t begin, size_t count) const -> void
+	{
+		const size_t line = 64;
+		for (const auto column : m_columns)
+		{
+			const size_t size = column->stride != 0 ? column->stride : column->type == column_type_e::float32 ? sizeof(float) : sizeof(double);
+			const auto data = static_cast<const char*>(column->data) + column->offset * size;
+			if (m_selection != nullptr)
+			{
+				for (size_t i = 0; i < count; i++)
+				{
+					EXPRCPP_PREFETCH(data + m_selection[begin + i] * size);
+				}
+				continue;
+			}
+			for (size_t offset = 0; offset < count * size; offset += line)
+			{
+				EXPRCPP_PREFETCH(data + begin * size + offset);
+			}
+		}
+	}
+
+	template<typename T>
+	auto batch_evaluator_t<T>::statement_slots(ast::stmt_id_t statement) -> size_t
+	{
+		if (statement == ast::null_id)
+		{
+			return 0;
+		}
+
+		const auto& node = m_ast->get_statement(statement);
+		switch (node.kind)
+		{
+		case ast::statement_kind_e::if_else:
+		{
+			const auto& if_else = std::get<ast::statement_t::stmt_if_else_t>(node.value);
+			return std::max({ 1 + expression_slots(if_else.condition), 1 + expression_slots(if_else.true_case), 2 + expression_slots(if_else.false_case) });
+		}
+		case ast::statement_kind_e::expr:
+		{
+			const auto& expr = std::get<ast::statement_t::stmt_expr_t>(node.value);
+			return expression_slots(expr.value);
+		}
+		}
+
+		return 0;
+	}
+
+	template<typename T>
+	auto batch_evaluator_t<T>::expression_slots(ast::expr_id_t expression) -> size_t
+	{
+		if (expression == ast::null_id)
+		{
+			return 0;
+		}
+
+		// Mirrors the scratch acquired by each evaluate_* while its children are evaluated
+		const auto& node = m_ast->get_expression(expression);
+		switch (node.kind)
+		{
+		case ast::expression_kind_e::bool_op:
+		{
+			const auto& bool_op = std::get<ast::expression_t::expr_bool_op_t>(node.value);
+			const auto elements = m_ast->get_list(bool_op.values);
+			size_t slots = 0;
+			for (size_t n = 0; n < elements.size(); n++)
+			{
+				slots = std::max(slots, (n > 0 ? 1 : 0) + expression_slots(elements[n]));
+			}
+			return slots;
+		}
+		case ast::expression_kind_e::bin_op:
+		{
+			const auto& bin_op = std::get<ast::expression_t::expr_bin_op_t>(node.value);
+			return std::max(expression_slots(bin_op.left), 1 + expression_slots(bin_op.right));
+		}
+		case ast::expression_kind_e::unary_op:
+		{
+			const auto& unary_op = std::get<ast::expression_t::expr_unary_op_t>(node.value);
+			return expression_slots(unary_op.right);
+		}
+		case ast::expression_kind_e::cmp_op:
+		{
+			const auto& cmp_op = std::get<ast::expression_t::expr_cmp_op_t>(node.value);
+			if ((cmp_op.op == ast::cmp_op_type_e::in || cmp_op.op == ast::cmp_op_type_e::not_in) &&
+				cmp_op.right != ast::null_id && m_ast->get_expression(cmp_op.right).kind == ast::expression_kind_e::vector)
+			{
+				const auto& vector = std::get<ast::expression_t::expr_vector_t>(m_ast->get_expression(cmp_op.right).value);
+				size_t slots = 0;
+				for (const auto element : m_ast->get_list(vector.elements))
+				{
+					slots = std::max(slots, expression_slots(element));
+				}
+				return std::max(expression_slots(cmp_op.left), 2 + slots);
+			}
+			return std::max(expression_slots(cmp_op.left), 1 + expression_slots(cmp_op.right));
+		}
+		case ast::expression_kind_e::name:
+		{
+			const auto& name = std::get<ast::expression_t::expr_name_t>(node.value);
+			const auto column = m_batch.get_column(m_ids[name.id]);
+			if (column != nullptr && std::find(m_columns.begin(), m_columns.end(), column) == m_columns.end())
+			{
+				m_columns.push_back(column);
+			}
+			return 0;
+		}
+		case ast::expression_kind_e::call:
+		{
+			const auto& call = std::get<ast::expression_t::expr_call_t>(node.value);
+			size_t slots = 0;
+			for (const auto arg : m_ast->get_list(call.args))
+			{
+				slots = std::max(slots, expression_slots(arg));
+			}
+			return std::max<size_t>(call.args.count + slots, 2 * call.args.count);
+		}
+		default:
+			return 0;
+		}
+	}
+
+	template<typename T>
+	auto batch_evaluator_t<T>::tile_size(size_t slots) const -> size_t
+	{
+		if (m_batch.tile_size() != 0)
+		{
+			return m_batch.tile_size();
+		}
+
+		// Scratch slots and the input columns of one tile should fit the budget
+		const size_t row_bytes = sizeof(T) * slots + sizeof(double) * m_columns.size() + sizeof(uint8_t);
+		size_t rows = constants::tile_cache_budget / row_bytes;
+		rows = std::clamp(rows - rows % constants::tile_min_rows, constants::tile_min_rows, constants::tile_max_rows);
+		return std::min(rows, std::max(m_rows, size_t(1)));
+	}
+
+}
\ No newline at end of file
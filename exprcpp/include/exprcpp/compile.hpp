@@ -0,0 +1,74 @@
+#pragma once
+
+#include <memory>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "exprcpp/ast.hpp"
+#include "exprcpp/tokenizer.hpp"
+
+namespace exprcpp
+{
+
+	namespace internal
+	{
+		class parser_t;
+	}
+
+	enum class compile_error_e
+	{
+		none,
+		invalid_token,		// A token does not lex, such as a number with an empty exponent
+		unexpected_token,
+		unexpected_end
+	};
+
+	// Filled without allocating, the text is only put together when a caller asks for the message
+	struct compile_error_t
+	{
+		compile_error_e code = compile_error_e::none;
+		uint32_t offset = 0;	// Position in the expression string of the token the parser stopped at
+		uint32_t length = 0;
+		internal::token_type_e expected = internal::TOK_UNKNOWN;	// Closing token that was missing, TOK_UNKNOWN when none was
+		const char* detail = nullptr;	// Why an invalid token did not lex
+
+		auto message(std::string_view expression_string) const -> std::string;
+	};
+
+	struct compile_result_t
+	{
+		std::shared_ptr<const internal::ast::tree_t> tree;	// nullptr when the expression failed to compile
+		compile_error_t error;
+
+		auto ok() const -> bool;
+	};
+
+	auto compile_tree(std::string_view expression_string) -> compile_result_t;
+
+	// Compiles every expression on a pool of worker threads, 0 uses one per hardware thread.
+	// Results line up with the input and nothing is printed, failures are reported in their result
+	auto compile_many(std::span<const std::string> expression_strings, size_t threads = 0) -> std::vector<compile_result_t>;
+	auto compile_many(std::span<const std::string_view> expression_strings, size_t threads = 0) -> std::vector<compile_result_t>;
+
+	// Compiles one formula as it is being edited. The tokens, memo table and subtrees of the last compile are kept,
+	// so an edit relexes only around the changed text and reparses only the expressions enclosing it
+	class incremental_compiler_t
+	{
+	public:
+		incremental_compiler_t();
+		~incremental_compiler_t();
+
+		auto compile(std::string_view expression_string) -> compile_result_t;
+		auto edit(size_t offset, size_t removed, std::string_view inserted) -> compile_result_t;
+		auto text() const -> const std::string&;
+	private:
+		auto result(bool parsed) -> compile_result_t;
+	private:
+		std::string m_text;
+		std::unique_ptr<internal::parser_t> m_parser;
+		std::shared_ptr<internal::ast::tree_t> m_tree;	// Handed out by the last compile, the parser takes it back on the next edit
+	};
+
+}
\ No newline at end of file
@@ -0,0 +1,92 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "exprcpp/ast.hpp"
+
+namespace exprcpp
+{
+
+	struct compile_cache_stats_t
+	{
+		uint64_t hits = 0;
+		uint64_t misses = 0;
+		uint64_t evictions = 0;
+		size_t size = 0;
+	};
+
+	// Maps normalized expression text and a symbol table identity to the tree it compiled to.
+	// Each shard is an independent LRU list behind its own mutex, so unrelated lookups rarely contend
+	class compile_cache_t
+	{
+	public:
+		typedef std::shared_ptr<const internal::ast::tree_t> tree_ptr_t;
+
+		explicit compile_cache_t(size_t capacity = 4096, size_t shards = 16);
+		~compile_cache_t() = default;
+
+		compile_cache_t(const compile_cache_t&) = delete;
+		auto operator=(const compile_cache_t&) -> compile_cache_t& = delete;
+
+		auto find(std::string_view expression_string, const void* symbol_table = nullptr) -> tree_ptr_t;
+		auto insert(std::string_view expression_string, tree_ptr_t tree, const void* symbol_table = nullptr) -> void;
+		auto clear() -> void;
+
+		auto capacity() const -> size_t;
+		auto stats() const -> compile_cache_stats_t;
+
+		// Trims the ends and folds runs of blanks, so formulas differing only in spacing share an entry
+		static auto normalize(std::string_view expression_string) -> std::string;
+	private:
+		// Views into the text owned by the entry, list nodes never move so the views stay valid
+		struct key_t
+		{
+			std::string_view text;
+			const void* symbol_table = nullptr;
+			size_t hash = 0;
+
+			auto operator==(const key_t& other) const -> bool;
+		};
+
+		// The hash is computed once per call and carried in the key, the map never rehashes the text
+		struct key_hash_t
+		{
+			auto operator()(const key_t& key) const -> size_t;
+		};
+
+		struct entry_t
+		{
+			std::string text;
+			const void* symbol_table = nullptr;
+			tree_ptr_t tree;
+		};
+
+		struct shard_t
+		{
+			std::mutex mutex;
+			std::list<entry_t> entries;	// Most recently used first
+			std::unordered_map<key_t, std::list<entry_t>::iterator, key_hash_t> index;
+		};
+
+		static auto make_key(std::string_view text, const void* symbol_table) -> key_t;
+		static auto normalized(std::string_view expression_string, std::string& buffer) -> std::string_view;
+		auto shard(size_t hash) -> shard_t&;
+	private:
+		size_t m_capacity;
+		size_t m_shard_capacity;
+		std::vector<std::unique_ptr<shard_t>> m_shards;
+
+		std::atomic<uint64_t> m_hits;
+		std::atomic<uint64_t> m_misses;
+		std::atomic<uint64_t> m_evictions;
+	};
+
+}
\ No newline at end of file
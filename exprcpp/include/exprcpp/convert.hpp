@@ -0,0 +1,52 @@
+#pragma once
+
+#include <string>
+#include <type_traits>
+
+namespace exprcpp
+{
+
+	template<class Integer, typename Enable = void> 
+	struct convert_to_number_t 
+	{ 
+		auto operator()(std::string const& str) const -> Integer 
+		{ 
+			return std::stoi(str); 
+		} 
+	}; 
+	
+	template<class Integer>
+	struct convert_to_number_t<Integer, std::enable_if_t<std::is_same<long, Integer>::value>> 
+	{
+		auto operator()(std::string const& str) const -> long 
+		{
+			return std::stol(str); 
+		} 
+	}; 
+	
+	template<class Float> 
+	struct convert_to_number_t<Float, std::enable_if_t<std::is_same<float, Float>::value>> 
+	{
+		auto operator()(std::string const& str) const -> float 
+		{ 
+			return std::stof(str); 
+		} 
+	}; 
+	
+	template<class Float> 
+	struct convert_to_number_t<Float, std::enable_if_t<std::is_same<double, Float>::value>> 
+	{ 
+		auto operator()(std::string const& str) const -> double 
+		{ 
+			return std::stod(str); 
+		} 
+	}; 
+	
+	template<class T, class StringLike> 
+	auto to_number(StringLike&& str) -> T 
+	{ 
+		using type = std::decay_t<T>;
+		return convert_to_number_t<type>()(str); 
+	};
+
+}
\ No newline at end of file
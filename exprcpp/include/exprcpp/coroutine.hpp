@@ -0,0 +1,127 @@
+#pragma once
+
+#include <coroutine>
+#include <exception>
+#include <functional>
+#include <iterator>
+#include <type_traits>
+
+namespace exprcpp
+{
+
+	// Posts a suspended coroutine to an event loop, which resumes it later on its own thread
+	typedef std::function<void(std::coroutine_handle<>)> scheduler_t;
+
+	template<typename R>
+	class task_t
+	{
+	public:
+		struct promise_type
+		{
+			// Transfers control to the awaiting coroutine once the task has finished
+			struct final_awaiter_t
+			{
+				auto await_ready() const noexcept -> bool;
+				auto await_suspend(std::coroutine_handle<promise_type> handle) const noexcept -> std::coroutine_handle<>;
+				auto await_resume() const noexcept -> void;
+			};
+
+			R value = R();
+			std::coroutine_handle<> continuation;
+			std::exception_ptr exception;
+
+			auto get_return_object() -> task_t;
+			auto initial_suspend() noexcept -> std::suspend_always;
+			auto final_suspend() noexcept -> final_awaiter_t;
+			auto return_value(R result) -> void;
+			auto unhandled_exception() -> void;
+		};
+
+		task_t(task_t&& other) noexcept;
+		task_t(const task_t&) = delete;
+		~task_t();
+
+		auto operator=(task_t&& other) noexcept -> task_t&;
+		auto operator=(const task_t&) = delete;
+
+		auto resume() -> bool;
+		auto done() const -> bool;
+		auto result() const -> const R&;
+
+		auto await_ready() const noexcept -> bool;
+		auto await_suspend(std::coroutine_handle<> continuation) noexcept -> std::coroutine_handle<>;
+		auto await_resume() -> R;
+	private:
+		explicit task_t(std::coroutine_handle<promise_type> handle);
+	private:
+		std::coroutine_handle<promise_type> m_handle;
+	};
+
+	template<typename U>
+	class generator_t
+	{
+	public:
+		struct promise_type
+		{
+			std::remove_reference_t<U>* value = nullptr;
+			std::exception_ptr exception;
+
+			auto get_return_object() -> generator_t;
+			auto initial_suspend() noexcept -> std::suspend_always;
+			auto final_suspend() noexcept -> std::suspend_always;
+			auto yield_value(std::remove_reference_t<U>& result) noexcept -> std::suspend_always;
+			auto yield_value(std::remove_reference_t<U>&& result) noexcept -> std::suspend_always;
+			auto return_void() -> void;
+			auto unhandled_exception() -> void;
+		};
+
+		class iterator_t
+		{
+		public:
+			using iterator_category = std::input_iterator_tag;
+			using difference_type = std::ptrdiff_t;
+			using value_type = std::remove_cvref_t<U>;
+
+			explicit iterator_t(std::coroutine_handle<promise_type> handle = nullptr);
+
+			auto operator*() const -> std::remove_reference_t<U>&;
+			auto operator++() -> iterator_t&;
+			auto operator++(int) -> void;
+			auto operator==(std::default_sentinel_t) const -> bool;
+		private:
+			std::coroutine_handle<promise_type> m_handle;
+		};
+
+		generator_t(generator_t&& other) noexcept;
+		generator_t(const generator_t&) = delete;
+		~generator_t();
+
+		auto operator=(generator_t&& other) noexcept -> generator_t&;
+		auto operator=(const generator_t&) = delete;
+
+		auto begin() -> iterator_t;
+		auto end() -> std::default_sentinel_t;
+	private:
+		explicit generator_t(std::coroutine_handle<promise_type> handle);
+	private:
+		std::coroutine_handle<promise_type> m_handle;
+	};
+
+	namespace internal
+	{
+
+		// Suspends between tiles, handing the coroutine to the scheduler when there is one
+		struct yield_t
+		{
+			const scheduler_t& scheduler;
+
+			auto await_ready() const noexcept -> bool;
+			auto await_suspend(std::coroutine_handle<> handle) const -> void;
+			auto await_resume() const noexcept -> void;
+		};
+
+	}
+
+}
+
+#include "coroutine.inl"
\ No newline at end of file
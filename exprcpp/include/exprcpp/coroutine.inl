@@ -0,0 +1,284 @@
+#include "coroutine.hpp"
+
+#include <utility>
+
+namespace exprcpp
+{
+
+	template<typename R>
+	auto task_t<R>::promise_type::final_awaiter_t::await_ready() const noexcept -> bool
+	{
+		return false;
+	}
+
+	template<typename R>
+	auto task_t<R>::promise_type::final_awaiter_t::await_suspend(std::coroutine_handle<promise_type> handle) const noexcept -> std::coroutine_handle<>
+	{
+		if (handle.promise().continuation)
+		{
+			return handle.promise().continuation;
+		}
+		return std::noop_coroutine();
+	}
+
+	template<typename R>
+	auto task_t<R>::promise_type::final_awaiter_t::await_resume() const noexcept -> void
+	{ }
+
+	template<typename R>
+	auto task_t<R>::promise_type::get_return_object() -> task_t
+	{
+		return task_t(std::coroutine_handle<promise_type>::from_promise(*this));
+	}
+
+	template<typename R>
+	auto task_t<R>::promise_type::initial_suspend() noexcept -> std::suspend_always
+	{
+		return {};
+	}
+
+	template<typename R>
+	auto task_t<R>::promise_type::final_suspend() noexcept -> final_awaiter_t
+	{
+		return {};
+	}
+
+	template<typename R>
+	auto task_t<R>::promise_type::return_value(R result) -> void
+	{
+		value = std::move(result);
+	}
+
+	template<typename R>
+	auto task_t<R>::promise_type::unhandled_exception() -> void
+	{
+		exception = std::current_exception();
+	}
+
+	template<typename R>
+	task_t<R>::task_t(std::coroutine_handle<promise_type> handle)
+		: m_handle(handle)
+	{ }
+
+	template<typename R>
+	task_t<R>::task_t(task_t&& other) noexcept
+		: m_handle(std::exchange(other.m_handle, nullptr))
+	{ }
+
+	template<typename R>
+	task_t<R>::~task_t()
+	{
+		if (m_handle)
+		{
+			m_handle.destroy();
+		}
+	}
+
+	template<typename R>
+	auto task_t<R>::operator=(task_t&& other) noexcept -> task_t&
+	{
+		if (this != &other)
+		{
+			if (m_handle)
+			{
+				m_handle.destroy();
+			}
+			m_handle = std::exchange(other.m_handle, nullptr);
+		}
+		return *this;
+	}
+
+	template<typename R>
+	auto task_t<R>::resume() -> bool
+	{
+		if (!m_handle || m_handle.done())
+		{
+			return false;
+		}
+		m_handle.resume();
+		return !m_handle.done();
+	}
+
+	template<typename R>
+	auto task_t<R>::done() const -> bool
+	{
+		return !m_handle || m_handle.done();
+	}
+
+	template<typename R>
+	auto task_t<R>::result() const -> const R&
+	{
+		if (m_handle.promise().exception)
+		{
+			std::rethrow_exception(m_handle.promise().exception);
+		}
+		return m_handle.promise().value;
+	}
+
+	template<typename R>
+	auto task_t<R>::await_ready() const noexcept -> bool
+	{
+		return done();
+	}
+
+	template<typename R>
+	auto task_t<R>::await_suspend(std::coroutine_handle<> continuation) noexcept -> std::coroutine_handle<>
+	{
+		m_handle.promise().continuation = continuation;
+		return m_handle;
+	}
+
+	template<typename R>
+	auto task_t<R>::await_resume() -> R
+	{
+		return result();
+	}
+
+	template<typename U>
+	auto generator_t<U>::promise_type::get_return_object() -> generator_t
+	{
+		return generator_t(std::coroutine_handle<promise_type>::from_promise(*this));
+	}
+
+	template<typename U>
+	auto generator_t<U>::promise_type::initial_suspend() noexcept -> std::suspend_always
+	{
+		return {};
+	}
+
+	template<typename U>
+	auto generator_t<U>::promise_type::final_suspend() noexcept -> std::suspend_always
+	{
+		return {};
+	}
+
+	template<typename U>
+	auto generator_t<U>::promise_type::yield_value(std::remove_reference_t<U>& result) noexcept -> std::suspend_always
+	{
+		value = std::addressof(result);
+		return {};
+	}
+
+	template<typename U>
+	auto generator_t<U>::promise_type::yield_value(std::remove_reference_t<U>&& result) noexcept -> std::suspend_always
+	{
+		value = std::addressof(result);
+		return {};
+	}
+
+	template<typename U>
+	auto generator_t<U>::promise_type::return_void() -> void
+	{ }
+
+	template<typename U>
+	auto generator_t<U>::promise_type::unhandled_exception() -> void
+	{
+		exception = std::current_exception();
+	}
+
+	template<typename U>
+	generator_t<U>::iterator_t::iterator_t(std::coroutine_handle<promise_type> handle)
+		: m_handle(handle)
+	{ }
+
+	template<typename U>
+	auto generator_t<U>::iterator_t::operator*() const -> std::remove_reference_t<U>&
+	{
+		return *m_handle.promise().value;
+	}
+
+	template<typename U>
+	auto generator_t<U>::iterator_t::operator++() -> iterator_t&
+	{
+		m_handle.resume();
+		if (m_handle.done() && m_handle.promise().exception)
+		{
+			std::rethrow_exception(m_handle.promise().exception);
+		}
+		return *this;
+	}
+
+	template<typename U>
+	auto generator_t<U>::iterator_t::operator++(int) -> void
+	{
+		++*this;
+	}
+
+	template<typename U>
+	auto generator_t<U>::iterator_t::operator==(std::default_sentinel_t) const -> bool
+	{
+		return !m_handle || m_handle.done();
+	}
+
+	template<typename U>
+	generator_t<U>::generator_t(std::coroutine_handle<promise_type> handle)
+		: m_handle(handle)
+	{ }
+
+	template<typename U>
+	generator_t<U>::generator_t(generator_t&& other) noexcept
+		: m_handle(std::exchange(other.m_handle, nullptr))
+	{ }
+
+	template<typename U>
+	generator_t<U>::~generator_t()
+	{
+		if (m_handle)
+		{
+			m_handle.destroy();
+		}
+	}
+
+	template<typename U>
+	auto generator_t<U>::operator=(generator_t&& other) noexcept -> generator_t&
+	{
+		if (this != &other)
+		{
+			if (m_handle)
+			{
+				m_handle.destroy();
+			}
+			m_handle = std::exchange(other.m_handle, nullptr);
+		}
+		return *this;
+	}
+
+	template<typename U>
+	auto generator_t<U>::begin() -> iterator_t
+	{
+		iterator_t iterator(m_handle);
+		if (m_handle)
+		{
+			++iterator;
+		}
+		return iterator;
+	}
+
+	template<typename U>
+	auto generator_t<U>::end() -> std::default_sentinel_t
+	{
+		return {};
+	}
+
+	namespace internal
+	{
+
+		inline auto yield_t::await_ready() const noexcept -> bool
+		{
+			return false;
+		}
+
+		inline auto yield_t::await_suspend(std::coroutine_handle<> handle) const -> void
+		{
+			if (scheduler)
+			{
+				scheduler(handle);
+			}
+		}
+
+		inline auto yield_t::await_resume() const noexcept -> void
+		{ }
+
+	}
+
+}
\ No newline at end of file
@@ -0,0 +1,47 @@
+#pragma once
+
+#include "exprcpp/expression.hpp"
+#include "exprcpp/symbol_table.hpp"
+#include <cstdint>
+#include <memory>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace exprcpp
+{
+
+	// Maps the change counter of every value to the expressions that read it, so finding what a tick affects costs as
+	// much as the changes it marked rather than a check of every expression. Expressions must outlive the index and
+	// should share their table, each distinct table is polled on every call
+	template<typename T>
+	class dependency_index_t
+	{
+	public:
+		// Returns the position the expression is known by. Once it is given another tree or table, update it
+		auto add(expression_t<T>& expression) -> size_t;
+		auto update(size_t position) -> void;
+
+		// Positions of the expressions whose cached result is stale, ascending. One stays in the list until it is evaluated
+		auto changed() -> const std::vector<size_t>&;
+		auto size() const -> size_t;
+	private:
+		auto rebuild() -> void;
+		auto mark(size_t position) -> void;
+		auto mark_all() -> void;
+	private:
+		std::vector<expression_t<T>*> m_expressions;
+		std::vector<std::pair<std::shared_ptr<const symbol_table_t<T>>, uint64_t>> m_tables;	// Layout version each was indexed at
+		std::vector<std::pair<std::shared_ptr<const symbol_table_t<T>>, uint64_t>> m_scopes;	// Local change version last visited
+		std::unordered_map<const uint64_t*, std::vector<uint32_t>> m_readers;
+		bool m_outdated = false;
+
+		std::vector<uint64_t> m_marks;	// Call each expression was last marked in
+		uint64_t m_call = 0;
+		std::vector<size_t> m_candidates;
+		std::vector<size_t> m_changed;
+	};
+
+}
+
+#include "dependency_index.inl"
\ No newline at end of file
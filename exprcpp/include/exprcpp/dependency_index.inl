@@ -0,0 +1,152 @@
+#include "dependency_index.hpp"
+
+#include <algorithm>
+
+namespace exprcpp
+{
+
+	template<typename T>
+	auto dependency_index_t<T>::add(expression_t<T>& expression) -> size_t
+	{
+		m_expressions.push_back(&expression);
+		m_marks.push_back(0);
+		m_outdated = true;
+		return m_expressions.size() - 1;
+	}
+
+	template<typename T>
+	auto dependency_index_t<T>::update(size_t position) -> void
+	{
+		if (position < m_expressions.size())
+		{
+			m_outdated = true;
+		}
+	}
+
+	template<typename T>
+	auto dependency_index_t<T>::changed() -> const std::vector<size_t>&
+	{
+		m_call++;
+		m_candidates.clear();
+		// Ones reported before and not evaluated since are still stale
+		for (const auto position : m_changed)
+		{
+			mark(position);
+		}
+
+		for (const auto& table : m_tables)
+		{
+			m_outdated = m_outdated || table.first->layout_version() != table.second;
+		}
+		if (m_outdated)
+		{
+			// Names were added or scopes moved, so the counters expressions read may be different ones now
+			rebuild();
+			mark_all();
+		}
+		else
+		{
+			for (auto& scope : m_scopes)
+			{
+				const auto changes = scope.first->local_change_version();
+				if (changes == scope.second)
+				{
+					continue;
+				}
+				const bool visited = scope.first->visit_changes(scope.second, [this](const uint64_t* counter)
+				{
+					const auto readers = m_readers.find(counter);
+					if (readers != m_readers.end())
+					{
+						for (const auto position : readers->second)
+						{
+							mark(position);
+						}
+					}
+				});
+				if (!visited)
+				{
+					mark_all();
+				}
+				scope.second = changes;
+			}
+		}
+
+		m_changed.clear();
+		for (const auto position : m_candidates)
+		{
+			const auto expression = m_expressions[position];
+			if (!expression->m_ast->empty() && expression->stale())
+			{
+				m_changed.push_back(position);
+			}
+		}
+		std::sort(m_changed.begin(), m_changed.end());
+		return m_changed;
+	}
+
+	template<typename T>
+	auto dependency_index_t<T>::size() const -> size_t
+	{
+		return m_expressions.size();
+	}
+
+	template<typename T>
+	auto dependency_index_t<T>::rebuild() -> void
+	{
+		m_tables.clear();
+		m_scopes.clear();
+		m_readers.clear();
+		for (size_t position = 0; position < m_expressions.size(); position++)
+		{
+			auto& expression = *m_expressions[position];
+			if (expression.m_ast->empty())
+			{
+				continue;
+			}
+			if (!expression.m_bound || expression.m_bound_version != expression.m_symbol_table->layout_version())
+			{
+				expression.bind();
+			}
+			for (const auto& input : expression.m_inputs)
+			{
+				m_readers[input.first].push_back(static_cast<uint32_t>(position));
+			}
+
+			std::shared_ptr<const symbol_table_t<T>> table = expression.m_symbol_table;
+			if (std::find_if(m_tables.begin(), m_tables.end(), [&](const auto& known) { return known.first == table; }) != m_tables.end())
+			{
+				continue;
+			}
+			m_tables.emplace_back(table, table->layout_version());
+			for (auto scope = table; scope != nullptr; scope = scope->parent())
+			{
+				if (std::find_if(m_scopes.begin(), m_scopes.end(), [&](const auto& known) { return known.first == scope; }) == m_scopes.end())
+				{
+					m_scopes.emplace_back(scope, scope->local_change_version());
+				}
+			}
+		}
+		m_outdated = false;
+	}
+
+	template<typename T>
+	auto dependency_index_t<T>::mark(size_t position) -> void
+	{
+		if (m_marks[position] != m_call)
+		{
+			m_marks[position] = m_call;
+			m_candidates.push_back(position);
+		}
+	}
+
+	template<typename T>
+	auto dependency_index_t<T>::mark_all() -> void
+	{
+		for (size_t position = 0; position < m_expressions.size(); position++)
+		{
+			mark(position);
+		}
+	}
+
+}
\ No newline at end of file
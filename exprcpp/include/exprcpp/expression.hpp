@@ -1,8 +1,17 @@
 #pragma once
 
 #include "exprcpp/symbol_table.hpp"
+#include "exprcpp/aggregate.hpp"
 #include "exprcpp/ast.hpp"
+#include "exprcpp/batch_evaluator.hpp"
+#include "exprcpp/convert.hpp"
+#include "exprcpp/coroutine.hpp"
+#include <algorithm>
+#include <map>
+#include <memory>
+#include <optional>
 #include <stack>
+#include <utility>
 
 namespace exprcpp
 {
@@ -59,8 +68,28 @@ namespace exprcpp
 		constexpr auto in(const stack_object_t<T>& lhs, const stack_object_t<T>& rhs) -> stack_object_t<T>;
 		template<typename T>
 		constexpr auto not_in(const stack_object_t<T>& lhs, const stack_object_t<T>& rhs) -> stack_object_t<T>;
+
+		// What binding learns about one node before the optimizer acts on it
+		struct node_facts_t
+		{
+			bool analyzed = false;
+			bool pure = false;		// Evaluating it has no effect and cannot fail
+			bool constant = false;	// Pure and reads no variable
+			double cost = 0;
+			uint32_t number = 0;	// Pure subtrees computing the same thing share a number
+		};
+
+		struct numbering_t
+		{
+			std::map<std::vector<uint64_t>, uint32_t> nodes;
+			std::map<std::string, uint32_t> literals;
+			uint32_t next = 0;
+		};
 	}
 
+	template<typename T>
+	class dependency_index_t;
+
 	template<typename T>
 	class expression_t
 	{
@@ -69,28 +98,83 @@ namespace exprcpp
 		~expression_t() = default;
 
 		auto value() -> T;
-
-		auto register_symbol_table(const symbol_table_t<T> symbol_table) -> void;
-		auto set_ast(const internal::ast::stmt_seq_ptr_t& ast) -> void;
+		// Returns the last result unless a value the expression reads was set or touched through its symbol table since,
+		// functions are assumed to give the same result for the same arguments
+		auto value_if_changed() -> T;
+		auto stale() const -> bool;
+		auto value(const batch_t& batch, batch_result_t<T>& result) -> bool;
+		auto value(const batch_t& batch, const selection_t& selection, batch_result_t<T>& result) -> bool;
+		auto filter(const batch_t& batch, selection_t& selection) -> bool;
+		auto filter(const batch_t& batch, std::vector<uint8_t>& bitmap) -> bool;
+		auto aggregate(const batch_t& batch, aggregator_t<T>& aggregator) -> bool;
+		auto aggregate(const batch_t& batch, const selection_t& selection, aggregator_t<T>& aggregator) -> bool;
+
+		// The batch and result must outlive the task, which suspends after every tile
+		auto value_async(const batch_t& batch, batch_result_t<T>& result, scheduler_t scheduler = nullptr) -> task_t<bool>;
+		auto value_stream(generator_t<batch_t> chunks) -> generator_t<batch_result_t<T>>;
+
+		// A table passed by reference or as a temporary is copied. Expressions registered with the same shared_ptr
+		// share the table, so assignments are visible to every one of them
+		auto register_symbol_table(std::shared_ptr<symbol_table_t<T>> symbol_table) -> void;
+		auto register_symbol_table(const symbol_table_t<T>& symbol_table) -> void;
+		auto register_symbol_table(symbol_table_t<T>&& symbol_table) -> void;
+		// Shares a table the caller owns without copying it. The table must outlive the expression
+		auto share_symbol_table(symbol_table_t<T>& symbol_table) -> void;
+		auto get_symbol_table() const -> const std::shared_ptr<symbol_table_t<T>>&;
+		auto set_ast(internal::ast::tree_t ast) -> void;
+		auto set_ast(std::shared_ptr<const internal::ast::tree_t> ast) -> void;
+		auto get_ast() const -> const std::shared_ptr<const internal::ast::tree_t>&;
 	private:
-		auto execute_statement(const internal::ast::stmt_ptr_t& statement) -> bool;
-		auto execute_if_else(const internal::ast::expr_ptr_t& condition, const internal::ast::expr_ptr_t& true_case, const internal::ast::expr_ptr_t& false_case) -> bool;
-		auto execute_expression(const internal::ast::expr_ptr_t& expression) -> bool;
-		auto execute_bool_op(internal::ast::bool_op_type_e op, const internal::ast::expr_seq_ptr_t& values) -> bool;
-		auto execute_bin_op(const internal::ast::expr_ptr_t& left, internal::ast::operator_type_e op, const internal::ast::expr_ptr_t& right) -> bool;
-		auto execute_unary_op(internal::ast::unary_op_type_e op, const internal::ast::expr_ptr_t& right) -> bool;
-		auto execute_cmp_op(const internal::ast::expr_ptr_t& left, internal::ast::cmp_op_type_e op, const internal::ast::expr_ptr_t& right) -> bool;
-		auto execute_assign(const std::string& id, const internal::ast::expr_ptr_t& value) -> bool;
-		auto execute_constant(const std::string& value) -> bool;
-		auto execute_name(const std::string& id, internal::ast::expr_context_type_e context) -> bool;
-		auto execute_vector(const internal::ast::expr_seq_ptr_t& elements) -> bool;
-		auto execute_call(const std::string& name, const internal::ast::expr_seq_ptr_t& args) -> bool;
-		auto execute_slice(const internal::ast::expr_ptr_t& vector, const internal::ast::expr_ptr_t& start, const internal::ast::expr_ptr_t& stop) -> bool;
+		friend class dependency_index_t<T>;
+
+		auto aggregate(const batch_t& batch, const uint32_t* selection, size_t rows, aggregator_t<T>& aggregator) -> bool;
+
+		auto bind() -> void;
+		// Folds pure calls on constants, shares the result of identical pure calls and orders pure boolean chains
+		// cheapest first, all without touching the tree, which other expressions may share
+		auto optimize() -> void;
+		auto analyze(internal::ast::expr_id_t node, std::vector<internal::node_facts_t>& facts, internal::numbering_t& numbering) -> const internal::node_facts_t&;
+		auto fold(internal::ast::expr_id_t node, const std::vector<internal::node_facts_t>& facts) -> void;
+		auto evaluate() -> T;
+
+		auto execute_statement(internal::ast::stmt_id_t statement) -> bool;
+		auto execute_if_else(internal::ast::expr_id_t condition, internal::ast::expr_id_t true_case, internal::ast::expr_id_t false_case) -> bool;
+		auto execute_expression(internal::ast::expr_id_t expression) -> bool;
+		auto execute_bool_op(internal::ast::expr_id_t node, internal::ast::bool_op_type_e op, const internal::ast::range_t& values) -> bool;
+		auto execute_bin_op(internal::ast::expr_id_t left, internal::ast::operator_type_e op, internal::ast::expr_id_t right) -> bool;
+		auto execute_unary_op(internal::ast::unary_op_type_e op, internal::ast::expr_id_t right) -> bool;
+		auto execute_cmp_op(internal::ast::expr_id_t left, internal::ast::cmp_op_type_e op, internal::ast::expr_id_t right) -> bool;
+		auto execute_assign(internal::ast::expr_id_t node, internal::string_id_t id, internal::ast::expr_id_t value) -> bool;
+		auto execute_constant(uint32_t value) -> bool;
+		auto execute_name(internal::ast::expr_id_t node, internal::string_id_t variable, internal::ast::expr_context_type_e context) -> bool;
+		auto execute_vector(const internal::ast::range_t& elements) -> bool;
+		auto execute_call(internal::ast::expr_id_t node, internal::string_id_t function, const internal::ast::range_t& args) -> bool;
+		auto execute_slice(internal::ast::expr_id_t vector, internal::ast::expr_id_t start, internal::ast::expr_id_t stop) -> bool;
 	private:
-		symbol_table_t<T> m_symbol_table;
-		internal::ast::stmt_seq_ptr_t m_ast;
+		std::shared_ptr<symbol_table_t<T>> m_symbol_table = std::make_shared<symbol_table_t<T>>();
+		std::shared_ptr<const internal::ast::tree_t> m_ast = std::make_shared<const internal::ast::tree_t>();	// Shared with the compile cache and other expressions
+
+		// One per tree node, taken again when the tree, the table or the layout of any of its scopes changes
+		std::vector<internal::binding_t<T>> m_bindings;
+		std::vector<internal::string_id_t> m_ids;	// The table's id for each name the tree numbers, invalid for one nobody interned
+		uint64_t m_bound_version = 0;
+		bool m_bound = false;
+
+		// Counters of every value the tree loads and what they read when the cached result was computed
+		std::vector<std::pair<const uint64_t*, uint64_t>> m_inputs;
+		uint64_t m_seen_changes = 0;
+		T m_result = T();
+		bool m_cached = false;
 
 		std::stack<internal::stack_object_t<T>> m_stack;
+		// Arguments of the calls in progress, nested calls stacked above their caller's. Sized when bound
+		std::vector<T> m_arguments;
+		size_t m_arguments_top = 0;
+
+		std::vector<T> m_folded;	// Never grows past the tree's size, so bindings can point into it
+		std::vector<std::pair<uint64_t, T>> m_memos;	// Evaluation a shared call result was computed in, and the result
+		std::vector<internal::ast::expr_id_t> m_order;
+		uint64_t m_evaluation = 0;
 	};
 
 }
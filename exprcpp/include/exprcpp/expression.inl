@@ -225,63 +225,72 @@ namespace exprcpp
 		}
 	}
 
-	template<class Integer, typename Enable = void> 
-	struct convert_to_number_t 
-	{ 
-		auto operator()(std::string const& str) const -> Integer 
-		{ 
-			return std::stoi(str); 
-		} 
-	}; 
-	
-	template<class Integer>
-	struct convert_to_number_t<Integer, std::enable_if_t<std::is_same<long, Integer>::value>> 
-	{
-		auto operator()(std::string const& str) const -> long 
-		{
-			return std::stol(str); 
-		} 
-	}; 
-	
-	template<class Float> 
-	struct convert_to_number_t<Float, std::enable_if_t<std::is_same<float, Float>::value>> 
-	{
-		auto operator()(std::string const& str) const -> float 
-		{ 
-			return std::stof(str); 
-		} 
-	}; 
-	
-	template<class Float> 
-	struct convert_to_number_t<Float, std::enable_if_t<std::is_same<double, Float>::value>> 
-	{ 
-		auto operator()(std::string const& str) const -> double 
-		{ 
-			return std::stod(str); 
-		} 
-	}; 
-	
-	template<class T, class StringLike> 
-	auto to_number(StringLike&& str) -> T 
-	{ 
-		using type = std::decay_t<T>;
-		return convert_to_number_t<type>()(str); 
-	};
-
 	template<typename T>
 	inline auto expression_t<T>::value() -> T
 	{
-		if (m_ast == nullptr)
+		if (m_ast->empty())
 		{
 			return T();
 		}
 
+		if (!m_bound || m_bound_version != m_symbol_table->layout_version())
+		{
+			bind();
+		}
+
+		// Taken before evaluating, so an expression that assigns one of its own inputs is stale again afterwards
+		m_seen_changes = m_symbol_table->change_version();
+		for (auto& input : m_inputs)
+		{
+			input.second = *input.first;
+		}
+		m_result = evaluate();
+		m_cached = true;
+		return m_result;
+	}
+
+	template<typename T>
+	auto expression_t<T>::value_if_changed() -> T
+	{
+		if (stale())
+		{
+			return value();
+		}
+		m_seen_changes = m_symbol_table->change_version();
+		return m_result;
+	}
+
+	template<typename T>
+	auto expression_t<T>::stale() const -> bool
+	{
+		if (!m_cached || !m_bound || m_bound_version != m_symbol_table->layout_version())
+		{
+			return true;
+		}
+		if (m_seen_changes == m_symbol_table->change_version())
+		{
+			return false;
+		}
+		for (const auto& input : m_inputs)
+		{
+			if (*input.first != input.second)
+			{
+				return true;
+			}
+		}
+		return false;
+	}
+
+	template<typename T>
+	inline auto expression_t<T>::evaluate() -> T
+	{
 		while (!m_stack.empty())
 		{
 			m_stack.pop();
 		}
+		m_evaluation++;
 
-		for (const auto& statement : m_ast->elements)
+		for (const auto statement : m_ast->statements())
 		{
 			if (!execute_statement(statement))
 			{
@@ -310,35 +319,518 @@ namespace exprcpp
 	}
 
 	template<typename T>
-	auto expression_t<T>::register_symbol_table(const symbol_table_t<T> symbol_table) -> void
+	auto expression_t<T>::value(const batch_t& batch, batch_result_t<T>& result) -> bool
+	{
+		internal::batch_evaluator_t<T> evaluator(*m_symbol_table, batch);
+		return evaluator.evaluate(*m_ast, result);
+	}
+
+	template<typename T>
+	auto expression_t<T>::value(const batch_t& batch, const selection_t& selection, batch_result_t<T>& result) -> bool
+	{
+		internal::batch_evaluator_t<T> evaluator(*m_symbol_table, batch);
+		return evaluator.evaluate(*m_ast, selection, result);
+	}
+
+	template<typename T>
+	auto expression_t<T>::filter(const batch_t& batch, selection_t& selection) -> bool
+	{
+		internal::batch_evaluator_t<T> evaluator(*m_symbol_table, batch);
+		return evaluator.filter(*m_ast, selection);
+	}
+
+	template<typename T>
+	auto expression_t<T>::filter(const batch_t& batch, std::vector<uint8_t>& bitmap) -> bool
 	{
-		m_symbol_table = symbol_table;
+		internal::batch_evaluator_t<T> evaluator(*m_symbol_table, batch);
+		return evaluator.filter(*m_ast, bitmap);
 	}
 
 	template<typename T>
-	auto expression_t<T>::set_ast(const internal::ast::stmt_seq_ptr_t& ast) -> void
+	auto expression_t<T>::aggregate(const batch_t& batch, aggregator_t<T>& aggregator) -> bool
 	{
-		m_ast = ast;
+		return aggregate(batch, nullptr, batch.rows(), aggregator);
 	}
 
 	template<typename T>
-	auto expression_t<T>::execute_statement(const internal::ast::stmt_ptr_t& statement) -> bool
+	auto expression_t<T>::aggregate(const batch_t& batch, const selection_t& selection, aggregator_t<T>& aggregator) -> bool
 	{
-		if (statement == nullptr)
+		return aggregate(batch, selection.data(), selection.size(), aggregator);
+	}
+
+	template<typename T>
+	auto expression_t<T>::aggregate(const batch_t& batch, const uint32_t* selection, size_t rows, aggregator_t<T>& aggregator) -> bool
+	{
+		const column_t* keys = nullptr;
+		if (!aggregator.group_by().empty() && (keys = batch.get_column(aggregator.group_by())) == nullptr)
+		{
+			return false;
+		}
+
+		// Results are folded tile by tile, nothing larger than a tile is ever materialized
+		internal::batch_evaluator_t<T> evaluator(*m_symbol_table, batch);
+		if (!evaluator.start(*m_ast, selection, rows))
 		{
 			return false;
 		}
 
-		switch (statement->kind)
+		internal::tile_t<T> tile;
+		while (evaluator.next_tile(tile, nullptr))
+		{
+			aggregator.add(keys, selection, tile.begin, tile.count, tile.values, tile.valid);
+		}
+		return !evaluator.failed();
+	}
+
+	template<typename T>
+	auto expression_t<T>::value_async(const batch_t& batch, batch_result_t<T>& result, scheduler_t scheduler) -> task_t<bool>
+	{
+		result.values.assign(batch.rows(), T());
+		result.null_count = 0;
+		result.validity.clear();
+
+		internal::batch_evaluator_t<T> evaluator(*m_symbol_table, batch);
+		if (!evaluator.start(*m_ast, nullptr, batch.rows()))
+		{
+			co_return false;
+		}
+
+		internal::tile_t<T> tile;
+		while (evaluator.next_tile(tile, result.values.data()))
+		{
+			internal::store_nulls(tile, result);
+			co_await internal::yield_t{ scheduler };
+		}
+		co_return !evaluator.failed();
+	}
+
+	template<typename T>
+	auto expression_t<T>::value_stream(generator_t<batch_t> chunks) -> generator_t<batch_result_t<T>>
+	{
+		// Each chunk is evaluated only when the consumer asks for its result, the stream ends at the first failure
+		for (auto& chunk : chunks)
+		{
+			batch_result_t<T> result;
+			if (!value(chunk, result))
+			{
+				co_return;
+			}
+			co_yield std::move(result);
+		}
+	}
+
+	template<typename T>
+	auto expression_t<T>::register_symbol_table(std::shared_ptr<symbol_table_t<T>> symbol_table) -> void
+	{
+		m_symbol_table = std::move(symbol_table);
+		m_bound = false;
+		m_cached = false;
+	}
+
+	template<typename T>
+	auto expression_t<T>::register_symbol_table(const symbol_table_t<T>& symbol_table) -> void
+	{
+		m_symbol_table = std::make_shared<symbol_table_t<T>>(symbol_table);
+		m_bound = false;
+		m_cached = false;
+	}
+
+	template<typename T>
+	auto expression_t<T>::register_symbol_table(symbol_table_t<T>&& symbol_table) -> void
+	{
+		m_symbol_table = std::make_shared<symbol_table_t<T>>(std::move(symbol_table));
+		m_bound = false;
+		m_cached = false;
+	}
+
+	template<typename T>
+	auto expression_t<T>::share_symbol_table(symbol_table_t<T>& symbol_table) -> void
+	{
+		// Aliases the table without owning it
+		m_symbol_table = std::shared_ptr<symbol_table_t<T>>(std::shared_ptr<void>(), &symbol_table);
+		m_bound = false;
+		m_cached = false;
+	}
+
+	template<typename T>
+	auto expression_t<T>::get_symbol_table() const -> const std::shared_ptr<symbol_table_t<T>>&
+	{
+		return m_symbol_table;
+	}
+
+	template<typename T>
+	auto expression_t<T>::set_ast(internal::ast::tree_t ast) -> void
+	{
+		m_ast = std::make_shared<const internal::ast::tree_t>(std::move(ast));
+		m_bound = false;
+		m_cached = false;
+	}
+
+	template<typename T>
+	auto expression_t<T>::set_ast(std::shared_ptr<const internal::ast::tree_t> ast) -> void
+	{
+		m_ast = std::move(ast);
+		m_bound = false;
+		m_cached = false;
+	}
+
+	template<typename T>
+	auto expression_t<T>::get_ast() const -> const std::shared_ptr<const internal::ast::tree_t>&
+	{
+		return m_ast;
+	}
+
+	template<typename T>
+	auto expression_t<T>::bind() -> void
+	{
+		m_bindings.assign(m_ast->size(), internal::binding_t<T>());
+		m_inputs.clear();
+		m_ids.clear();
+		for (const auto& name : m_ast->names())
+		{
+			m_ids.push_back(internal::global_interner().find(name));
+		}
+		size_t arguments = 0;
+		for (internal::ast::expr_id_t id = 1; id < m_ast->size(); id++)
+		{
+			const auto& node = m_ast->get_expression(id);
+			switch (node.kind)
+			{
+			case internal::ast::expression_kind_e::assign:
+			{
+				const auto& assign = std::get<internal::ast::expression_t::expr_assign_t>(node.value);
+				m_bindings[id].target = m_symbol_table->find(m_ids[assign.id]);
+				break;
+			}
+			case internal::ast::expression_kind_e::name:
+			{
+				const auto& name = std::get<internal::ast::expression_t::expr_name_t>(node.value);
+				if (name.context == internal::ast::expr_context_type_e::store)
+				{
+					m_bindings[id].target = m_symbol_table->find(m_ids[name.id]);
+				}
+				else
+				{
+					m_bindings[id].value = m_symbol_table->resolve(m_ids[name.id]);
+					m_bindings[id].generation = m_symbol_table->generation(m_ids[name.id]);
+					if (m_bindings[id].generation != nullptr)
+					{
+						m_inputs.emplace_back(m_bindings[id].generation, 0);
+					}
+				}
+				break;
+			}
+			case internal::ast::expression_kind_e::call:
+			{
+				const auto& call = std::get<internal::ast::expression_t::expr_call_t>(node.value);
+				m_bindings[id].function = m_symbol_table->get_function(m_ids[call.name]);
+				arguments += call.args.count;
+				break;
+			}
+			default:
+				break;
+			}
+		}
+		std::sort(m_inputs.begin(), m_inputs.end());
+		m_inputs.erase(std::unique(m_inputs.begin(), m_inputs.end()), m_inputs.end());
+		// Enough for every call to be nested in another, so evaluating never grows it
+		m_arguments.resize(arguments);
+		m_arguments_top = 0;
+
+		optimize();
+
+		m_bound_version = m_symbol_table->layout_version();
+		m_bound = true;
+		m_cached = false;
+	}
+
+	template<typename T>
+	auto expression_t<T>::optimize() -> void
+	{
+		m_folded.clear();
+		m_folded.reserve(m_ast->size());
+		m_memos.clear();
+		m_order.clear();
+
+		std::vector<internal::node_facts_t> facts(m_ast->size());
+		internal::numbering_t numbering;
+		bool effects = false;
+		for (internal::ast::expr_id_t id = 1; id < m_ast->size(); id++)
+		{
+			const auto& node = m_ast->get_expression(id);
+			analyze(id, facts, numbering);
+			effects |= node.kind == internal::ast::expression_kind_e::assign ||
+				(node.kind == internal::ast::expression_kind_e::name && std::get<internal::ast::expression_t::expr_name_t>(node.value).context != internal::ast::expr_context_type_e::load) ||
+				(node.kind == internal::ast::expression_kind_e::call && !facts[id].pure);
+		}
+
+		// Children come before their parents, so inner calls are folded before the calls around them
+		for (internal::ast::expr_id_t id = 1; id < m_ast->size(); id++)
+		{
+			fold(id, facts);
+		}
+
+		// A variable could change between two identical calls if anything in the tree has an effect
+		if (!effects)
+		{
+			std::map<uint32_t, std::vector<internal::ast::expr_id_t>> calls;
+			for (internal::ast::expr_id_t id = 1; id < m_ast->size(); id++)
+			{
+				if (m_ast->get_expression(id).kind == internal::ast::expression_kind_e::call && facts[id].pure && m_bindings[id].folded == nullptr)
+				{
+					calls[facts[id].number].push_back(id);
+				}
+			}
+			for (const auto& [number, ids] : calls)
+			{
+				if (ids.size() < 2)
+				{
+					continue;
+				}
+				m_memos.emplace_back(0, T());
+				for (const auto id : ids)
+				{
+					m_bindings[id].memo = static_cast<uint32_t>(m_memos.size());
+				}
+			}
+		}
+
+		for (internal::ast::expr_id_t id = 1; id < m_ast->size(); id++)
+		{
+			const auto& node = m_ast->get_expression(id);
+			if (node.kind != internal::ast::expression_kind_e::bool_op)
+			{
+				continue;
+			}
+			const auto values = m_ast->get_list(std::get<internal::ast::expression_t::expr_bool_op_t>(node.value).values);
+			if (values.size() < 2 || !std::all_of(values.begin(), values.end(), [&](auto value) { return facts[value].pure; }))
+			{
+				continue;
+			}
+			m_bindings[id].order = static_cast<uint32_t>(m_order.size() + 1);
+			m_order.insert(m_order.end(), values.begin(), values.end());
+			std::stable_sort(m_order.end() - values.size(), m_order.end(), [&](auto left, auto right) { return facts[left].cost < facts[right].cost; });
+		}
+	}
+
+	template<typename T>
+	auto expression_t<T>::analyze(internal::ast::expr_id_t node, std::vector<internal::node_facts_t>& facts, internal::numbering_t& numbering) -> const internal::node_facts_t&
+	{
+		static const internal::node_facts_t missing;
+		if (node == internal::ast::null_id)
+		{
+			return missing;
+		}
+		if (facts[node].analyzed)
+		{
+			return facts[node];
+		}
+
+		// The key lists what the node computes in terms of the numbers of its children
+		const auto& expression = m_ast->get_expression(node);
+		std::vector<uint64_t> key = { static_cast<uint64_t>(expression.kind) };
+		internal::node_facts_t result;
+		result.pure = true;
+		result.constant = true;
+		const auto child = [&](internal::ast::expr_id_t id)
+		{
+			const auto& known = analyze(id, facts, numbering);
+			result.pure &= known.pure;
+			result.constant &= known.constant;
+			result.cost += known.cost;
+			key.push_back(known.number);
+		};
+
+		switch (expression.kind)
+		{
+		case internal::ast::expression_kind_e::bool_op:
+		{
+			const auto& bool_op = std::get<internal::ast::expression_t::expr_bool_op_t>(expression.value);
+			key.push_back(static_cast<uint64_t>(bool_op.op));
+			for (const auto value : m_ast->get_list(bool_op.values))
+			{
+				child(value);
+			}
+			break;
+		}
+		case internal::ast::expression_kind_e::bin_op:
+		{
+			const auto& bin_op = std::get<internal::ast::expression_t::expr_bin_op_t>(expression.value);
+			key.push_back(static_cast<uint64_t>(bin_op.op));
+			child(bin_op.left);
+			child(bin_op.right);
+			result.cost += 1;
+			break;
+		}
+		case internal::ast::expression_kind_e::unary_op:
+		{
+			const auto& unary_op = std::get<internal::ast::expression_t::expr_unary_op_t>(expression.value);
+			key.push_back(static_cast<uint64_t>(unary_op.op));
+			child(unary_op.right);
+			result.cost += 1;
+			break;
+		}
+		case internal::ast::expression_kind_e::cmp_op:
+		{
+			const auto& cmp_op = std::get<internal::ast::expression_t::expr_cmp_op_t>(expression.value);
+			key.push_back(static_cast<uint64_t>(cmp_op.op));
+			child(cmp_op.left);
+			child(cmp_op.right);
+			result.cost += 1;
+			break;
+		}
+		case internal::ast::expression_kind_e::constant:
+		{
+			const auto& text = m_ast->get_constant(std::get<internal::ast::expression_t::expr_constant_t>(expression.value).value);
+			auto literal = numbering.literals.try_emplace(text, numbering.next);
+			if (literal.second)
+			{
+				numbering.next++;
+			}
+			key.push_back(literal.first->second);
+			break;
+		}
+		case internal::ast::expression_kind_e::name:
+		{
+			const auto& name = std::get<internal::ast::expression_t::expr_name_t>(expression.value);
+			key.push_back(name.id);
+			result.pure = name.context == internal::ast::expr_context_type_e::load && m_bindings[node].value != nullptr;
+			result.constant = false;
+			result.cost = 1;
+			break;
+		}
+		case internal::ast::expression_kind_e::call:
+		{
+			const auto& call = std::get<internal::ast::expression_t::expr_call_t>(expression.value);
+			const auto function = m_bindings[node].function;
+			key.push_back(call.name);
+			for (const auto arg : m_ast->get_list(call.args))
+			{
+				child(arg);
+			}
+			result.pure &= function != nullptr && function->info().pure && (call.args.count == 0 || function->accepts(call.args.count));
+			result.cost += function != nullptr ? function->info().cost : 0;
+			break;
+		}
+		default:
+			// Assignments have an effect, vectors and slices can make the operators around them fail
+			result.pure = false;
+			break;
+		}
+
+		result.constant &= result.pure;
+		if (result.pure)
+		{
+			auto number = numbering.nodes.try_emplace(std::move(key), numbering.next);
+			if (number.second)
+			{
+				numbering.next++;
+			}
+			result.number = number.first->second;
+		}
+		else
+		{
+			result.number = numbering.next++;
+		}
+		result.analyzed = true;
+		facts[node] = result;
+		return facts[node];
+	}
+
+	template<typename T>
+	auto expression_t<T>::fold(internal::ast::expr_id_t node, const std::vector<internal::node_facts_t>& facts) -> void
+	{
+		const auto& expression = m_ast->get_expression(node);
+		std::optional<T> folded;
+		if (expression.kind == internal::ast::expression_kind_e::call && facts[node].constant)
+		{
+			if (execute_expression(node))
+			{
+				const auto& result = m_stack.top();
+				if (result.type == internal::stack_object_type_e::scalar)
+				{
+					folded = std::get<T>(result.value);
+				}
+				m_stack.pop();
+			}
+		}
+		else if (expression.kind == internal::ast::expression_kind_e::cmp_op)
+		{
+			// A comparison against a constant can be settled by the range a pure call promises to stay within
+			const auto& cmp_op = std::get<internal::ast::expression_t::expr_cmp_op_t>(expression.value);
+			auto op = cmp_op.op;
+			auto call = cmp_op.left;
+			auto constant = cmp_op.right;
+			if (call != internal::ast::null_id && m_ast->get_expression(call).kind != internal::ast::expression_kind_e::call)
+			{
+				std::swap(call, constant);
+				switch (op)
+				{
+				case internal::ast::cmp_op_type_e::lt: op = internal::ast::cmp_op_type_e::gt; break;
+				case internal::ast::cmp_op_type_e::lt_eq: op = internal::ast::cmp_op_type_e::gt_eq; break;
+				case internal::ast::cmp_op_type_e::gt: op = internal::ast::cmp_op_type_e::lt; break;
+				case internal::ast::cmp_op_type_e::gt_eq: op = internal::ast::cmp_op_type_e::lt_eq; break;
+				default: break;
+				}
+			}
+			if (call == internal::ast::null_id || constant == internal::ast::null_id || m_ast->get_expression(call).kind != internal::ast::expression_kind_e::call ||
+				!facts[call].pure || !facts[constant].constant || m_bindings[call].folded != nullptr || !execute_expression(constant))
+			{
+				return;
+			}
+			const auto& result = m_stack.top();
+			const T value = result.type == internal::stack_object_type_e::scalar ? std::get<T>(result.value) : T(0);
+			const bool scalar = result.type == internal::stack_object_type_e::scalar;
+			m_stack.pop();
+
+			const auto& info = m_bindings[call].function->info();
+			if (!scalar || !info.bounded)
+			{
+				return;
+			}
+			switch (op)
+			{
+			case internal::ast::cmp_op_type_e::eq: if (value < info.min || value > info.max) folded = T(0); break;
+			case internal::ast::cmp_op_type_e::Not_eq: if (value < info.min || value > info.max) folded = T(1); break;
+			case internal::ast::cmp_op_type_e::lt: if (info.max < value) folded = T(1); else if (info.min >= value) folded = T(0); break;
+			case internal::ast::cmp_op_type_e::lt_eq: if (info.max <= value) folded = T(1); else if (info.min > value) folded = T(0); break;
+			case internal::ast::cmp_op_type_e::gt: if (info.min > value) folded = T(1); else if (info.max <= value) folded = T(0); break;
+			case internal::ast::cmp_op_type_e::gt_eq: if (info.min >= value) folded = T(1); else if (info.max < value) folded = T(0); break;
+			default: break;
+			}
+			// A NaN result would still compare false, or true for !=, so the other answer needs NaN ruled out
+			if (folded && info.nan && *folded != T(op == internal::ast::cmp_op_type_e::Not_eq))
+			{
+				folded.reset();
+			}
+		}
+
+		if (folded)
+		{
+			m_folded.push_back(*folded);
+			m_bindings[node].folded = &m_folded.back();
+		}
+	}
+
+	template<typename T>
+	auto expression_t<T>::execute_statement(internal::ast::stmt_id_t statement) -> bool
+	{
+		if (statement == internal::ast::null_id)
+		{
+			return false;
+		}
+
+		const auto& node = m_ast->get_statement(statement);
+		switch (node.kind)
 		{
 		case internal::ast::statement_kind_e::if_else:
 		{
-			auto if_else = std::get<internal::ast::statement_t::stmt_if_else_t>(statement->value);
+			const auto& if_else = std::get<internal::ast::statement_t::stmt_if_else_t>(node.value);
 			return execute_if_else(if_else.condition, if_else.true_case, if_else.false_case);
 		}
 		case internal::ast::statement_kind_e::expr:
 		{
-			auto expr = std::get<internal::ast::statement_t::stmt_expr_t>(statement->value);
+			const auto& expr = std::get<internal::ast::statement_t::stmt_expr_t>(node.value);
 			return execute_expression(expr.value);
 		}
 		}
@@ -347,9 +839,9 @@ namespace exprcpp
 	}
 
 	template<typename T>
-	inline auto expression_t<T>::execute_if_else(const internal::ast::expr_ptr_t& condition, const internal::ast::expr_ptr_t& true_case, const internal::ast::expr_ptr_t& false_case) -> bool
+	inline auto expression_t<T>::execute_if_else(internal::ast::expr_id_t condition, internal::ast::expr_id_t true_case, internal::ast::expr_id_t false_case) -> bool
 	{
-		if (condition == nullptr || true_case == nullptr)
+		if (condition == internal::ast::null_id || true_case == internal::ast::null_id)
 		{
 			return false;
 		}
@@ -374,71 +866,76 @@ namespace exprcpp
 		{
 			return true;
 		}
-		else if (false_case != nullptr && execute_expression(false_case))
+		else if (false_case != internal::ast::null_id && execute_expression(false_case))
 		{
-			return false;
+			return true;
 		}
 		return false;
 	}
 
 	template<typename T>
-	auto expression_t<T>::execute_expression(const internal::ast::expr_ptr_t& expression) -> bool
+	auto expression_t<T>::execute_expression(internal::ast::expr_id_t expression) -> bool
 	{
-		if (expression == nullptr)
+		if (expression == internal::ast::null_id)
 		{
 			return false;
 		}
-
-		switch (expression->kind)
+		const auto& node = m_ast->get_expression(expression);
+		switch (node.kind)
 		{
 		case internal::ast::expression_kind_e::bool_op:
 		{
-			auto bool_op = std::get<internal::ast::expression_t::expr_bool_op_t>(expression->value);
-			return execute_bool_op(bool_op.op, bool_op.values);
+			const auto& bool_op = std::get<internal::ast::expression_t::expr_bool_op_t>(node.value);
+			return execute_bool_op(expression, bool_op.op, bool_op.values);
 		}
 		case internal::ast::expression_kind_e::bin_op:
 		{
-			auto bin_op = std::get<internal::ast::expression_t::expr_bin_op_t>(expression->value);
+			const auto& bin_op = std::get<internal::ast::expression_t::expr_bin_op_t>(node.value);
 			return execute_bin_op(bin_op.left, bin_op.op, bin_op.right);
 		}
 		case internal::ast::expression_kind_e::unary_op:
 		{
-			auto unary_op = std::get<internal::ast::expression_t::expr_unary_op_t>(expression->value);
+			const auto& unary_op = std::get<internal::ast::expression_t::expr_unary_op_t>(node.value);
 			return execute_unary_op(unary_op.op, unary_op.right);
 		}
 		case internal::ast::expression_kind_e::cmp_op:
 		{
-			auto cmp_op = std::get<internal::ast::expression_t::expr_cmp_op_t>(expression->value);
+			if (const auto folded = m_bindings[expression].folded)
+			{
+				m_stack.push(internal::stack_object_t<T>(*folded));
+				return true;
+			}
+			const auto& cmp_op = std::get<internal::ast::expression_t::expr_cmp_op_t>(node.value);
 			return execute_cmp_op(cmp_op.left, cmp_op.op, cmp_op.right);
 		}
 		case internal::ast::expression_kind_e::assign:
 		{
-			auto assign = std::get<internal::ast::expression_t::expr_assign_t>(expression->value);
-			return execute_assign(assign.id, assign.value);
+			const auto& assign = std::get<internal::ast::expression_t::expr_assign_t>(node.value);
+			return execute_assign(expression, assign.id, assign.value);
 		}
 		case internal::ast::expression_kind_e::constant:
 		{
-			auto constant = std::get<internal::ast::expression_t::expr_constant_t>(expression->value);
+			const auto& constant = std::get<internal::ast::expression_t::expr_constant_t>(node.value);
 			return execute_constant(constant.value);
 		}
 		case internal::ast::expression_kind_e::name:
 		{
-			auto name = std::get<internal::ast::expression_t::expr_name_t>(expression->value);
-			return execute_name(name.id, name.context);
+			const auto& name = std::get<internal::ast::expression_t::expr_name_t>(node.value);
+			return execute_name(expression, name.id, name.context);
 		}
 		case internal::ast::expression_kind_e::vector:
 		{
-			auto vector = std::get<internal::ast::expression_t::expr_vector_t>(expression->value);
+			const auto& vector = std::get<internal::ast::expression_t::expr_vector_t>(node.value);
 			return execute_vector(vector.elements);
 		}
 		case internal::ast::expression_kind_e::call:
 		{
-			auto call = std::get<internal::ast::expression_t::expr_call_t>(expression->value);
-			return execute_call(call.name, call.args);
+			const auto& call = std::get<internal::ast::expression_t::expr_call_t>(node.value);
+			return execute_call(expression, call.name, call.args);
 		}
 		case internal::ast::expression_kind_e::slice:
 		{
-			auto slice = std::get<internal::ast::expression_t::expr_slice_t>(expression->value);
+			const auto& slice = std::get<internal::ast::expression_t::expr_slice_t>(node.value);
 			return execute_slice(slice.vector, slice.start, slice.stop);
 		}
 		}
@@ -447,15 +944,39 @@ namespace exprcpp
 	}
 
 	template<typename T>
-	auto expression_t<T>::execute_bool_op(internal::ast::bool_op_type_e op, const internal::ast::expr_seq_ptr_t& values) -> bool
+	auto expression_t<T>::execute_bool_op(internal::ast::expr_id_t node, internal::ast::bool_op_type_e op, const internal::ast::range_t& values) -> bool
 	{
-		if (values == nullptr || values->elements.size() == 0)
+		if (values.count == 0)
 		{
 			return false;
 		}
 
+		if (const auto order = m_bindings[node].order)
+		{
+			// Every operand is pure, so stopping once the result is known cannot be told apart from evaluating them all
+			const bool all = op == internal::ast::bool_op_type_e::And;
+			bool result = all;
+			for (size_t n = 0; n < values.count; n++)
+			{
+				if (!execute_expression(m_order[order - 1 + n]))
+				{
+					return false;
+				}
+				const auto& stack_value = m_stack.top();
+				const bool value = stack_value.type == internal::stack_object_type_e::scalar && std::get<T>(stack_value.value);
+				m_stack.pop();
+				if (value != all)
+				{
+					result = !all;
+					break;
+				}
+			}
+			m_stack.push(internal::stack_object_t<T>(T(result)));
+			return true;
+		}
+
 		std::vector<T> expr_values;
-		for (const auto& expr : values->elements)
+		for (const auto expr : m_ast->get_list(values))
 		{
 			if (!execute_expression(expr))
 			{
@@ -491,9 +1012,9 @@ namespace exprcpp
 	}
 
 	template<typename T>
-	auto expression_t<T>::execute_bin_op(const internal::ast::expr_ptr_t& left, internal::ast::operator_type_e op, const internal::ast::expr_ptr_t& right) -> bool
+	auto expression_t<T>::execute_bin_op(internal::ast::expr_id_t left, internal::ast::operator_type_e op, internal::ast::expr_id_t right) -> bool
 	{
-		if ((left == nullptr || right == nullptr) || (!execute_expression(left) || !execute_expression(right)))
+		if ((left == internal::ast::null_id || right == internal::ast::null_id) || (!execute_expression(left) || !execute_expression(right)))
 		{
 			return false;
 		}
@@ -517,9 +1038,9 @@ namespace exprcpp
 	}
 
 	template<typename T>
-	auto expression_t<T>::execute_unary_op(internal::ast::unary_op_type_e op, const internal::ast::expr_ptr_t& right) -> bool
+	auto expression_t<T>::execute_unary_op(internal::ast::unary_op_type_e op, internal::ast::expr_id_t right) -> bool
 	{
-		if (right == nullptr || !execute_expression(right))
+		if (right == internal::ast::null_id || !execute_expression(right))
 		{
 			return false;
 		}
@@ -554,9 +1075,9 @@ namespace exprcpp
 	}
 
 	template<typename T>
-	inline auto expression_t<T>::execute_cmp_op(const internal::ast::expr_ptr_t& left, internal::ast::cmp_op_type_e op, const internal::ast::expr_ptr_t& right) -> bool
+	inline auto expression_t<T>::execute_cmp_op(internal::ast::expr_id_t left, internal::ast::cmp_op_type_e op, internal::ast::expr_id_t right) -> bool
 	{
-		if ((left == nullptr || right == nullptr) || (!execute_expression(left) || !execute_expression(right)))
+		if ((left == internal::ast::null_id || right == internal::ast::null_id) || (!execute_expression(left) || !execute_expression(right)))
 		{
 			return false;
 		}
@@ -584,36 +1105,38 @@ namespace exprcpp
 	}
 
 	template<typename T>
-	inline auto expression_t<T>::execute_assign(const std::string& id, const internal::ast::expr_ptr_t& value) -> bool
+	inline auto expression_t<T>::execute_assign(internal::ast::expr_id_t node, internal::string_id_t id, internal::ast::expr_id_t value) -> bool
 	{
-		if (value == nullptr || !execute_expression(value))
+		if (value == internal::ast::null_id || !execute_expression(value))
 		{
 			return false;
 		}
 
-		auto result = execute_name(id, internal::ast::expr_context_type_e::store);
+		return execute_name(node, id, internal::ast::expr_context_type_e::store);
 	}
 
 	template<typename T>
-	auto expression_t<T>::execute_constant(const std::string& value) -> bool
+	auto expression_t<T>::execute_constant(uint32_t value) -> bool
 	{
-		m_stack.push(internal::stack_object_t<T>(to_number<T>(value)));
+		m_stack.push(internal::stack_object_t<T>(to_number<T>(m_ast->get_constant(value))));
 		return true;
 	}
 
 	template<typename T>
-	auto expression_t<T>::execute_name(const std::string& id, internal::ast::expr_context_type_e context) -> bool
+	auto expression_t<T>::execute_name(internal::ast::expr_id_t node, internal::string_id_t variable, internal::ast::expr_context_type_e context) -> bool
 	{
 		switch (context)
 		{
 		case internal::ast::expr_context_type_e::load:
 		{
-			if (!m_symbol_table.has(id))
+			// A name that was missing at bind time may have been added since
+			auto value = m_bindings[node].value;
+			if (value == nullptr && (value = m_symbol_table->resolve(internal::global_interner().find(m_ast->get_name(variable)))) == nullptr)
 			{
 				return false;
 			}
 
-			m_stack.push(internal::stack_object_t<T>(m_symbol_table[id]));
+			m_stack.push(internal::stack_object_t<T>(*value));
 			return true;
 		}
 		case internal::ast::expr_context_type_e::store:
@@ -630,11 +1153,16 @@ namespace exprcpp
 				}
 			}
 
-			if (m_symbol_table.has(id))
+			// Assignments land in the innermost scope, shadowing any outer value of the same name
+			auto target = m_bindings[node].target;
+			if (target == nullptr)
 			{
-				m_symbol_table[id] = var_value;
+				const auto& name = m_ast->get_name(variable);
+				target = &m_symbol_table->get_variable(name);
+				m_ids[variable] = internal::global_interner().find(name);
 			}
-			m_symbol_table.add_variable(id, var_value);
+			*target = var_value;
+			m_symbol_table->touch(m_ids[variable]);
 			return true;
 		}
 		case internal::ast::expr_context_type_e::del:
@@ -647,17 +1175,17 @@ namespace exprcpp
 	}
 
 	template<typename T>
-	auto expression_t<T>::execute_vector(const internal::ast::expr_seq_ptr_t& elements) -> bool
+	auto expression_t<T>::execute_vector(const internal::ast::range_t& elements) -> bool
 	{
-		if (elements == nullptr)
+		if (elements.count == 0)
 		{
 			return false;
 		}
 
 		std::vector<T> vector_elements;
-		for (const auto& value : elements->elements)
+		for (const auto expr : m_ast->get_list(elements))
 		{
-			if (!execute_expression(value))
+			if (!execute_expression(expr))
 			{
 				return false;
 			}
@@ -681,66 +1209,69 @@ namespace exprcpp
 	}
 
 	template<typename T>
-	auto expression_t<T>::execute_call(const std::string& name, const internal::ast::expr_seq_ptr_t& args) -> bool
+	auto expression_t<T>::execute_call(internal::ast::expr_id_t node, internal::string_id_t function, const internal::ast::range_t& args) -> bool
 	{
-		if (!m_symbol_table.has_function(name))
+		const auto& binding = m_bindings[node];
+		if (binding.folded != nullptr)
 		{
-			return false;
+			m_stack.push(internal::stack_object_t<T>(*binding.folded));
+			return true;
 		}
-
-		auto func = m_symbol_table.get_function(name);
-		if (args == nullptr)
+		const auto memo = binding.memo;
+		if (memo != 0 && m_memos[memo - 1].first == m_evaluation)
 		{
-			T value = (*func)();
-			m_stack.push(internal::stack_object_t<T>(value));
+			m_stack.push(internal::stack_object_t<T>(m_memos[memo - 1].second));
 			return true;
 		}
-		else if (args->elements.size() != func->num_args())
+
+		auto func = binding.function;
+		if (func == nullptr && (func = m_symbol_table->get_function(m_ast->get_name(function))) == nullptr)
+		{
+			return false;
+		}
+		if ((args.count != 0 && !func->accepts(args.count)) || m_arguments_top + args.count > m_arguments.size())
 		{
 			return false;
 		}
 
-		std::vector<T> arg_values;
-		for (const auto& expr : args->elements)
+		const size_t base = m_arguments_top;
+		m_arguments_top += args.count;
+		for (size_t n = 0; n < args.count; n++)
 		{
-			if (!execute_expression(expr))
+			if (!execute_expression(m_ast->get_list(args)[n]))
 			{
+				m_arguments_top = base;
 				return false;
 			}
 
-			const auto stack_value = m_stack.top();
-			m_stack.pop();
+			const auto& stack_value = m_stack.top();
 			T value = stack_value.type == internal::stack_object_type_e::scalar ? std::get<T>(stack_value.value) : T(0);
 			if (stack_value.type == internal::stack_object_type_e::vector)
 			{
-				const auto vector = std::get<std::vector<T>>(stack_value.value);
+				const auto& vector = std::get<std::vector<T>>(stack_value.value);
 				if (vector.size() > 0)
 				{
 					value = vector[0];
 				}
 			}
-			arg_values.push_back(value);
+			m_stack.pop();
+			m_arguments[base + n] = value;
 		}
 
-		T value = T(0);
-		switch (args->elements.size())
+		const T value = func->invoke(std::span<const T>(m_arguments.data() + base, args.count));
+		m_arguments_top = base;
+		if (memo != 0)
 		{
-		case 0: value = (*func)(); break;
-		case 1: value = (*func)(arg_values[0]); break;
-		case 2: value = (*func)(arg_values[0], arg_values[1]); break;
-		case 3: value = (*func)(arg_values[0], arg_values[1], arg_values[2]); break;
-		case 4: value = (*func)(arg_values[0], arg_values[1], arg_values[2], arg_values[3]); break;
-		default: return false;
+			m_memos[memo - 1] = { m_evaluation, value };
 		}
-		
 		m_stack.push(internal::stack_object_t<T>(value));
 		return true;
 	}
 
 	template<typename T>
-	auto expression_t<T>::execute_slice(const internal::ast::expr_ptr_t& vector, const internal::ast::expr_ptr_t& start, const internal::ast::expr_ptr_t& stop) -> bool
+	auto expression_t<T>::execute_slice(internal::ast::expr_id_t vector, internal::ast::expr_id_t start, internal::ast::expr_id_t stop) -> bool
 	{
-		if (vector == nullptr || !execute_expression(vector))
+		if (vector == internal::ast::null_id || !execute_expression(vector))
 		{
 			return false;
 		}
@@ -755,7 +1286,7 @@ namespace exprcpp
 		int start_pos = 0;
 		int end_pos = vector_value.size();
 
-		if (start != nullptr && execute_expression(start))
+		if (start != internal::ast::null_id && execute_expression(start))
 		{
 			const auto stack_start = m_stack.top();
 			m_stack.pop();
@@ -770,7 +1301,7 @@ namespace exprcpp
 			}
 		}
 
-		if (stop != nullptr && execute_expression(stop))
+		if (stop != internal::ast::null_id && execute_expression(stop))
 		{
 			const auto stack_stop = m_stack.top();
 			m_stack.pop();
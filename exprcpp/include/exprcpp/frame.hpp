@@ -0,0 +1,48 @@
+#pragma once
+
+#include "exprcpp/symbol_table.hpp"
+#include <memory>
+#include <span>
+#include <string>
+#include <vector>
+
+namespace exprcpp
+{
+
+	// Input variables laid out once in a contiguous frame, so a request replaces all of them with one copy instead of
+	// looking every name up. The table reads the frame in place and sees a whole assignment as a single change
+	template<typename T>
+	class variable_frame_t
+	{
+	public:
+		variable_frame_t() = default;
+		variable_frame_t(const variable_frame_t&) = delete;
+		variable_frame_t(variable_frame_t&& other) noexcept;
+		~variable_frame_t() = default;
+
+		auto operator=(const variable_frame_t&) -> variable_frame_t& = delete;
+		auto operator=(variable_frame_t&& other) noexcept -> variable_frame_t&;
+
+		// Gives each name the next slot and binds it in the table. The table shares the values, so they outlive a frame
+		// that goes first, but assign, touch and slot need the table. A frame binds once
+		auto bind(symbol_table_t<T>& symbol_table, std::vector<std::string> names) -> bool;
+		// Copies one value per name, in the order they were bound
+		auto assign(std::span<const T> values) -> bool;
+		// Marks the frame changed after writing to it through values()
+		auto touch() -> void;
+
+		auto slot(std::string_view name) const -> size_t;
+		auto names() const -> const std::vector<std::string>&;
+		auto values() const -> std::span<const T>;
+		auto values() -> std::span<T>;
+		auto size() const -> size_t;
+	private:
+		std::vector<std::string> m_names;
+		std::shared_ptr<T[]> m_values;
+		size_t m_size = 0;
+		symbol_table_t<T>* m_symbol_table = nullptr;
+	};
+
+}
+
+#include "frame.inl"
\ No newline at end of file
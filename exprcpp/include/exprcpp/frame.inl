@@ -0,0 +1,111 @@
+#include "frame.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <utility>
+
+namespace exprcpp
+{
+
+	template<typename T>
+	variable_frame_t<T>::variable_frame_t(variable_frame_t&& other) noexcept
+		: m_names(std::move(other.m_names))
+		, m_values(std::move(other.m_values))
+		, m_size(std::exchange(other.m_size, 0))
+		, m_symbol_table(std::exchange(other.m_symbol_table, nullptr))
+	{ }
+
+	template<typename T>
+	auto variable_frame_t<T>::operator=(variable_frame_t&& other) noexcept -> variable_frame_t&
+	{
+		// The values this frame was bound to stay with its table, they just can no longer be written through a frame
+		m_names = std::move(other.m_names);
+		m_values = std::move(other.m_values);
+		m_size = std::exchange(other.m_size, 0);
+		m_symbol_table = std::exchange(other.m_symbol_table, nullptr);
+		return *this;
+	}
+
+	template<typename T>
+	auto variable_frame_t<T>::bind(symbol_table_t<T>& symbol_table, std::vector<std::string> names) -> bool
+	{
+		if (m_symbol_table != nullptr || names.empty())
+		{
+			return false;
+		}
+
+		auto values = std::make_shared<T[]>(names.size(), T(0));
+		if (!symbol_table.add_variables(names, values))
+		{
+			return false;
+		}
+		m_size = names.size();
+		m_names = std::move(names);
+		m_values = std::move(values);
+		m_symbol_table = &symbol_table;
+		return true;
+	}
+
+	template<typename T>
+	auto variable_frame_t<T>::assign(std::span<const T> values) -> bool
+	{
+		if (m_symbol_table == nullptr || values.size() != m_size)
+		{
+			return false;
+		}
+		std::copy(values.begin(), values.end(), m_values.get());
+		touch();
+		return true;
+	}
+
+	template<typename T>
+	auto variable_frame_t<T>::touch() -> void
+	{
+		if (m_symbol_table != nullptr)
+		{
+			m_symbol_table->touch(m_names.front());
+		}
+	}
+
+	template<typename T>
+	auto variable_frame_t<T>::slot(std::string_view name) const -> size_t
+	{
+		if (m_symbol_table == nullptr)
+		{
+			return SIZE_MAX;
+		}
+
+		// The table already maps the name to its value, whose place in the frame is the slot
+		const auto value = m_symbol_table->find(internal::global_interner().find(name));
+		if (value == nullptr || value < m_values.get() || value >= m_values.get() + m_size)
+		{
+			return SIZE_MAX;
+		}
+		return static_cast<size_t>(value - m_values.get());
+	}
+
+	template<typename T>
+	auto variable_frame_t<T>::names() const -> const std::vector<std::string>&
+	{
+		return m_names;
+	}
+
+	template<typename T>
+	auto variable_frame_t<T>::values() const -> std::span<const T>
+	{
+		return std::span<const T>(m_values.get(), m_size);
+	}
+
+	template<typename T>
+	auto variable_frame_t<T>::values() -> std::span<T>
+	{
+		return std::span<T>(m_values.get(), m_size);
+	}
+
+	template<typename T>
+	auto variable_frame_t<T>::size() const -> size_t
+	{
+		return m_size;
+	}
+
+}
\ No newline at end of file
@@ -2,18 +2,48 @@
 
 #include <algorithm>
 #include <cmath>
+#include <cstdint>
+#include <limits>
+#include <span>
+#include <tuple>
+#include <type_traits>
+#include <utility>
 
 namespace exprcpp
 {
 
+	// What the optimizer may assume about a function. Nothing is assumed unless it is filled in
+	template<typename T>
+	struct function_info_t
+	{
+		bool pure = false;		// The result only depends on the arguments and calling it has no other effect
+		double cost = 10;		// Rough cost of one call, where loading a value or one operator costs 1
+		bool bounded = false;	// Every result other than NaN lies within [min, max]
+		T min = T();
+		T max = T();
+		bool nan = true;		// Some results may be NaN, which fails every comparison but !=
+	};
+
 	template<typename T>
 	class function_t
 	{
 	public:
+		static constexpr size_t variadic = SIZE_MAX;	// Number of arguments of a function that takes any number
+
 		explicit function_t(const size_t& num_args);
 		virtual ~function_t() = default;
 
 		auto num_args() const -> const size_t;
+		auto accepts(size_t count) const -> bool;
+		auto info() const -> const function_info_t<T>&;
+		auto set_info(const function_info_t<T>& info) -> void;
+
+		// What evaluators call, through a plain function pointer rather than the vtable
+		inline auto invoke(std::span<const T> args) -> T;
+
+		// Evaluators pass the arguments side by side in a buffer they own. The default forwards to the fixed
+		// overloads below, a variadic function overrides this instead
+		inline virtual T call(std::span<const T> args);
 
 #define empty_method_body(N)						 \
     {                                              \
@@ -27,10 +57,94 @@ namespace exprcpp
 		inline virtual T operator() (const T&, const T&, const T&, const T&) empty_method_body(4);
 
 #undef empty_method_body
+	protected:
+		typedef T (*thunk_t)(function_t* function, std::span<const T> args);
+
+		// Lets a subclass that knows its own type be called without going through call
+		function_t(const size_t& num_args, thunk_t thunk);
+	private:
+		static auto virtual_thunk(function_t* function, std::span<const T> args) -> T;
 	private:
 		const size_t m_num_args;
+		const thunk_t m_thunk;
+		function_info_t<T> m_info;
 	};
 
+	namespace internal
+	{
+
+		// Parameter list of a free function, function pointer or callable object with a single operator()
+		template<typename F>
+		struct callable_traits_t : callable_traits_t<decltype(&F::operator())>
+		{ };
+
+		template<typename R, typename... A>
+		struct callable_traits_t<R(A...)>
+		{
+			typedef std::tuple<A...> args_t;
+			static constexpr size_t arity = sizeof...(A);
+		};
+
+		template<typename R, typename... A>
+		struct callable_traits_t<R(*)(A...)> : callable_traits_t<R(A...)>
+		{ };
+
+		template<typename R, typename... A>
+		struct callable_traits_t<R(*)(A...) noexcept> : callable_traits_t<R(A...)>
+		{ };
+
+		template<typename C, typename R, typename... A>
+		struct callable_traits_t<R(C::*)(A...)> : callable_traits_t<R(A...)>
+		{ };
+
+		template<typename C, typename R, typename... A>
+		struct callable_traits_t<R(C::*)(A...) const> : callable_traits_t<R(A...)>
+		{ };
+
+		template<typename C, typename R, typename... A>
+		struct callable_traits_t<R(C::*)(A...) noexcept> : callable_traits_t<R(A...)>
+		{ };
+
+		template<typename C, typename R, typename... A>
+		struct callable_traits_t<R(C::*)(A...) const noexcept> : callable_traits_t<R(A...)>
+		{ };
+
+		// A callable taking a span of values is variadic, otherwise it takes one value per parameter
+		template<typename T, typename F>
+		constexpr auto callable_arity() -> size_t
+		{
+			if constexpr (std::is_invocable_r_v<T, F&, std::span<const T>>)
+			{
+				return function_t<T>::variadic;
+			}
+			else
+			{
+				return callable_traits_t<F>::arity;
+			}
+		}
+
+		// Owns a callable registered by value. Its thunk calls the callable directly, so the compiler sees the
+		// concrete type and can inline it into the thunk instead of dispatching through the vtable
+		template<typename T, typename F>
+		class callable_function_t final : public function_t<T>
+		{
+		public:
+			using function_t<T>::operator();
+
+			callable_function_t(F function, const function_info_t<T>& info);
+
+			T call(std::span<const T> args) override;
+		private:
+			template<size_t... I>
+			auto apply(std::span<const T> args, std::index_sequence<I...>) -> T;
+
+			static auto thunk(function_t<T>* function, std::span<const T> args) -> T;
+		private:
+			F m_function;
+		};
+
+	}
+
 	template<typename T>
 	struct abs_ipml_t : public exprcpp::function_t<T>
 	{
@@ -39,6 +153,7 @@ namespace exprcpp
 		abs_ipml_t()
 			: exprcpp::function_t<T>(1)
 		{
+			this->set_info({ true, 1, true, T(0), std::numeric_limits<T>::infinity() });
 		}
 
 		auto operator()(const T& v) -> T
@@ -55,6 +170,7 @@ namespace exprcpp
 		ceil_ipml_t()
 			: exprcpp::function_t<T>(1)
 		{
+			this->set_info({ true, 2 });
 		}
 
 		auto operator()(const T& v) -> T
@@ -71,6 +187,7 @@ namespace exprcpp
 		clamp_ipml_t()
 			: exprcpp::function_t<T>(3)
 		{
+			this->set_info({ true, 2 });
 		}
 
 		auto operator()(const T& lo, const T&v, const T& hi) -> T
@@ -87,6 +204,7 @@ namespace exprcpp
 		floor_ipml_t()
 			: exprcpp::function_t<T>(1)
 		{
+			this->set_info({ true, 2 });
 		}
 
 		auto operator()(const T& v) -> T
@@ -103,6 +221,7 @@ namespace exprcpp
 		frac_ipml_t()
 			: exprcpp::function_t<T>(1)
 		{
+			this->set_info({ true, 3 });
 		}
 
 		auto operator()(const T& v) -> T
@@ -120,6 +239,7 @@ namespace exprcpp
 		inrange_ipml_t()
 			: exprcpp::function_t<T>(3)
 		{
+			this->set_info({ true, 2, true, T(0), T(1), false });
 		}
 
 		auto operator()(const T& lo, const T& v, const T& hi) -> T
@@ -136,6 +256,7 @@ namespace exprcpp
 		log_ipml_t()
 			: exprcpp::function_t<T>(1)
 		{
+			this->set_info({ true, 20 });
 		}
 
 		auto operator()(const T& v) -> T
@@ -152,6 +273,7 @@ namespace exprcpp
 		log10_ipml_t()
 			: exprcpp::function_t<T>(1)
 		{
+			this->set_info({ true, 20 });
 		}
 
 		auto operator()(const T& v) -> T
@@ -168,6 +290,7 @@ namespace exprcpp
 		log1p_ipml_t()
 			: exprcpp::function_t<T>(1)
 		{
+			this->set_info({ true, 20 });
 		}
 
 		auto operator()(const T& v) -> T
@@ -184,6 +307,7 @@ namespace exprcpp
 		log2_ipml_t()
 			: exprcpp::function_t<T>(1)
 		{
+			this->set_info({ true, 20 });
 		}
 
 		auto operator()(const T& v) -> T
@@ -200,6 +324,7 @@ namespace exprcpp
 		round_ipml_t()
 			: exprcpp::function_t<T>(1)
 		{
+			this->set_info({ true, 2 });
 		}
 
 		auto operator()(const T& v) -> T
@@ -224,6 +349,7 @@ namespace exprcpp
 		trunc_ipml_t()
 			: exprcpp::function_t<T>(1)
 		{
+			this->set_info({ true, 2 });
 		}
 
 		auto operator()(const T& v) -> T
@@ -6,6 +6,13 @@ namespace exprcpp
 	template<typename T>
 	function_t<T>::function_t(const size_t& num_args)
 		: m_num_args(num_args)
+		, m_thunk(&function_t::virtual_thunk)
+	{ }
+
+	template<typename T>
+	function_t<T>::function_t(const size_t& num_args, thunk_t thunk)
+		: m_num_args(num_args)
+		, m_thunk(thunk)
 	{ }
 
 	template<typename T>
@@ -14,4 +21,94 @@ namespace exprcpp
 		return m_num_args;
 	}
 
+	template<typename T>
+	inline auto function_t<T>::accepts(size_t count) const -> bool
+	{
+		return m_num_args == variadic || count == m_num_args;
+	}
+
+	template<typename T>
+	auto function_t<T>::info() const -> const function_info_t<T>&
+	{
+		return m_info;
+	}
+
+	template<typename T>
+	auto function_t<T>::set_info(const function_info_t<T>& info) -> void
+	{
+		m_info = info;
+	}
+
+	template<typename T>
+	inline auto function_t<T>::invoke(std::span<const T> args) -> T
+	{
+		return m_thunk(this, args);
+	}
+
+	template<typename T>
+	inline T function_t<T>::call(std::span<const T> args)
+	{
+		switch (args.size())
+		{
+		case 0: return (*this)();
+		case 1: return (*this)(args[0]);
+		case 2: return (*this)(args[0], args[1]);
+		case 3: return (*this)(args[0], args[1], args[2]);
+		case 4: return (*this)(args[0], args[1], args[2], args[3]);
+		}
+		return std::numeric_limits<T>::quiet_NaN();
+	}
+
+	template<typename T>
+	auto function_t<T>::virtual_thunk(function_t* function, std::span<const T> args) -> T
+	{
+		return function->call(args);
+	}
+
+	namespace internal
+	{
+
+		template<typename T, typename F>
+		callable_function_t<T, F>::callable_function_t(F function, const function_info_t<T>& info)
+			: function_t<T>(callable_arity<T, F>(), &callable_function_t::thunk)
+			, m_function(std::move(function))
+		{
+			this->set_info(info);
+		}
+
+		template<typename T, typename F>
+		T callable_function_t<T, F>::call(std::span<const T> args)
+		{
+			return thunk(this, args);
+		}
+
+		template<typename T, typename F>
+		template<size_t... I>
+		auto callable_function_t<T, F>::apply(std::span<const T> args, std::index_sequence<I...>) -> T
+		{
+			return T(m_function(static_cast<std::tuple_element_t<I, typename callable_traits_t<F>::args_t>>(args[I])...));
+		}
+
+		template<typename T, typename F>
+		auto callable_function_t<T, F>::thunk(function_t<T>* function, std::span<const T> args) -> T
+		{
+			auto self = static_cast<callable_function_t*>(function);
+			if constexpr (callable_arity<T, F>() == function_t<T>::variadic)
+			{
+				return T(self->m_function(args));
+			}
+			else
+			{
+				// A call without arguments reaches every function, whatever its arity
+				constexpr size_t arity = callable_traits_t<F>::arity;
+				if (args.size() != arity)
+				{
+					return std::numeric_limits<T>::quiet_NaN();
+				}
+				return self->apply(args, std::make_index_sequence<arity>());
+			}
+		}
+
+	}
+
 }
\ No newline at end of file
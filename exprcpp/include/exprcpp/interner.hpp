@@ -0,0 +1,104 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <shared_mutex>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace exprcpp::internal
+{
+
+	typedef uint32_t string_id_t;
+
+	const string_id_t invalid_string_id = UINT32_MAX;
+
+	// Hands out one dense id per distinct string for as long as anyone holds a reference to it. Symbol tables and
+	// batches hold one per name they contain, trees keep their own names, so nothing a parse sees is interned.
+	// An id nobody holds is freed and handed to the next new string. Strings never move while they are held,
+	// so get() needs no lock. Past max_chunks * chunk_size strings held at once intern() returns invalid_string_id
+	class interner_t
+	{
+	public:
+		interner_t();
+		~interner_t();
+
+		interner_t(const interner_t&) = delete;
+		auto operator=(const interner_t&) -> interner_t& = delete;
+
+		// Returns the id with one reference taken, which the caller releases
+		auto intern(std::string_view text) -> string_id_t;
+		auto find(std::string_view text) const -> string_id_t;
+		auto acquire(string_id_t id) -> void;
+		auto release(string_id_t id) -> void;
+		// Only meaningful for an id the caller holds, a freed id may already name another string
+		auto get(string_id_t id) const -> const std::string&;
+		// Strings currently held
+		auto size() const -> size_t;
+	private:
+		struct entry_t
+		{
+			std::string text;
+			std::atomic<uint32_t> references;
+			bool live = false;	// Only changed under the exclusive lock
+		};
+
+		auto entry(string_id_t id) const -> entry_t&;
+		auto lookup(std::string_view text, size_t hash) const -> string_id_t;
+		auto insert(string_id_t id, size_t hash) -> void;
+		auto erase(string_id_t id, size_t hash) -> void;
+		auto rehash(size_t slots) -> void;
+	private:
+		static const size_t chunk_bits = 10;
+		static const size_t chunk_size = size_t(1) << chunk_bits;
+		static const size_t max_chunks = 4096;
+
+		mutable std::shared_mutex m_mutex;
+		std::atomic<entry_t*> m_chunks[max_chunks];
+		std::atomic<uint32_t> m_size;	// Ids handed out so far, freed ones included
+		size_t m_live = 0;
+		std::vector<string_id_t> m_free;
+		std::vector<uint32_t> m_slots;	// Open addressing over the held strings, holds id + 1 so 0 marks an empty slot
+	};
+
+	// Shared by every symbol table and batch, so the same name has the same id everywhere
+	auto global_interner() -> interner_t&;
+
+	// References to interned ids, taken again by a copy and released on destruction
+	class string_refs_t
+	{
+	public:
+		string_refs_t() = default;
+		string_refs_t(const string_refs_t& other);
+		string_refs_t(string_refs_t&& other) noexcept;
+		~string_refs_t();
+
+		auto operator=(const string_refs_t& other) -> string_refs_t&;
+		auto operator=(string_refs_t&& other) noexcept -> string_refs_t&;
+
+		// Takes a reference of its own to an id the caller holds
+		auto add(string_id_t id) -> void;
+	private:
+		auto clear() -> void;
+	private:
+		std::vector<string_id_t> m_ids;
+	};
+
+	// Interns a string for as long as it lives, so its id cannot be reused while it is handed on
+	class interned_t
+	{
+	public:
+		explicit interned_t(std::string_view text);
+		~interned_t();
+
+		interned_t(const interned_t&) = delete;
+		auto operator=(const interned_t&) -> interned_t& = delete;
+
+		auto id() const -> string_id_t;
+	private:
+		string_id_t m_id;
+	};
+
+}
\ No newline at end of file
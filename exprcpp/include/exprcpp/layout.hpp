@@ -0,0 +1,42 @@
+#pragma once
+
+#include "exprcpp/batch.hpp"
+#include <cstddef>
+#include <span>
+#include <string>
+#include <vector>
+
+namespace exprcpp
+{
+
+	struct field_t
+	{
+		std::string name;
+		column_type_e type = column_type_e::float64;
+		size_t offset = 0;	// Bytes from the start of the struct
+	};
+
+	// Where the fields of S live, registered once. Binding a span of S turns every field into a strided column
+	// over the structs themselves, so they are evaluated in place without being copied into separate arrays
+	template<typename S>
+	class struct_layout_t
+	{
+	public:
+		struct_layout_t() = default;
+		~struct_layout_t() = default;
+
+		template<typename F>
+		auto add_field(const std::string& name, F S::* member) -> bool;
+		auto add_field(const std::string& name, column_type_e type, size_t offset) -> bool;
+
+		auto fields() const -> const std::vector<field_t>&;
+
+		// The rows must outlive the batch
+		auto bind(std::span<const S> rows) const -> batch_t;
+	private:
+		std::vector<field_t> m_fields;
+	};
+
+}
+
+#include "layout.inl"
\ No newline at end of file
@@ -0,0 +1,98 @@
+#include "layout.hpp"
+
+#include <cstdint>
+#include <type_traits>
+
+namespace exprcpp
+{
+
+	namespace internal
+	{
+
+		template<typename F>
+		constexpr auto field_type() -> column_type_e
+		{
+			if constexpr (std::is_same_v<F, double>)
+			{
+				return column_type_e::float64;
+			}
+			else if constexpr (std::is_same_v<F, float>)
+			{
+				return column_type_e::float32;
+			}
+			else
+			{
+				static_assert(std::is_same_v<F, int64_t>, "exprcpp: unsupported field type");
+				return column_type_e::int64;
+			}
+		}
+
+		inline auto column_type_size(column_type_e type) -> size_t
+		{
+			return type == column_type_e::float32 ? sizeof(float) : sizeof(double);
+		}
+
+	}
+
+	template<typename S>
+	template<typename F>
+	auto struct_layout_t<S>::add_field(const std::string& name, F S::* member) -> bool
+	{
+		// The offset is taken on uninitialised storage, S is never constructed
+		alignas(S) unsigned char storage[sizeof(S)];
+		const auto object = reinterpret_cast<const S*>(storage);
+		const auto offset = reinterpret_cast<const unsigned char*>(&(object->*member)) - storage;
+		return add_field(name, internal::field_type<F>(), static_cast<size_t>(offset));
+	}
+
+	template<typename S>
+	auto struct_layout_t<S>::add_field(const std::string& name, column_type_e type, size_t offset) -> bool
+	{
+		if (offset + internal::column_type_size(type) > sizeof(S))
+		{
+			return false;
+		}
+		for (const auto& field : m_fields)
+		{
+			if (field.name == name)
+			{
+				return false;
+			}
+		}
+
+		field_t field;
+		field.name = name;
+		field.type = type;
+		field.offset = offset;
+		m_fields.push_back(std::move(field));
+		return true;
+	}
+
+	template<typename S>
+	auto struct_layout_t<S>::fields() const -> const std::vector<field_t>&
+	{
+		return m_fields;
+	}
+
+	template<typename S>
+	auto struct_layout_t<S>::bind(std::span<const S> rows) const -> batch_t
+	{
+		batch_t batch(rows.size());
+		if (rows.empty())
+		{
+			return batch;
+		}
+
+		for (const auto& field : m_fields)
+		{
+			column_t column;
+			column.type = field.type;
+			column.data = reinterpret_cast<const unsigned char*>(rows.data()) + field.offset;
+			column.length = rows.size();
+			column.stride = sizeof(S);
+			batch.add_column(field.name, column);
+		}
+		return batch;
+	}
+
+}
\ No newline at end of file
@@ -1,58 +1,119 @@
 #pragma once
 
+#include <string_view>
 #include <vector>
 
+#include "exprcpp/ast.hpp"
 #include "exprcpp/tokenizer.hpp"
 
 namespace exprcpp::internal
 {
 
+	struct memo_t
+	{
+		ast::expr_id_t node = ast::null_id;
+		int mark = -1;	// Token position after the memoized rule, -1 while the entry is empty
+		uint32_t reach = 0;	// Furthest token the rule itself looked at
+		token_type_e expected = TOK_UNKNOWN;	// Closing token the rule found missing at its reach
+	};
+
+	// Where a failed parse gave up, which is the furthest token any rule looked at
+	struct parse_failure_t
+	{
+		token_t token;
+		token_type_e expected = TOK_UNKNOWN;	// Closing token a rule required there, TOK_UNKNOWN when none did
+		const char* message = nullptr;			// Set when the token did not lex
+	};
+
 	class parser_t
 	{
 	public:
-		parser_t(const std::string& expression_string);
+		parser_t(std::string_view expression_string);
 		~parser_t() = default;
 
-		auto compile() -> ast::stmt_seq_ptr_t;
+		// Starts over on another expression, keeping the token and memo buffers allocated
+		auto reset(std::string_view expression_string) -> void;
+		auto compile(ast::tree_t& tree) -> bool;
+		auto failure() const -> parse_failure_t;
+
+		// Parses into a tree the parser keeps, so a later edit can reuse its subtrees
+		auto parse() -> bool;
+		auto tree() -> ast::tree_t&;
+
+		// Moves on to the edited text, keeping the tokens, memo entries and subtrees the edit did not touch
+		auto edit(std::string_view expression_string, size_t offset, size_t removed, size_t inserted) -> void;
 	private:
 		auto fill_token() -> token_type_e;
 		auto expect_token(token_type_e type) -> bool;
-		auto expect_token(token_type_e type, token_ptr_t& token) -> bool;
-
-		auto is_memoized(int type, ast::node_ptr_t& pres) -> bool;
-		auto insert_memo(size_t mark, int type, ast::node_ptr_t node) -> bool;
-		auto update_memo(size_t mark, int type, ast::node_ptr_t node) -> bool;
-
-		auto rule_statements() -> ast::stmt_seq_ptr_t;
-		auto rule_statement() -> ast::stmt_ptr_t;
-		auto rule_simple_statement() -> ast::stmt_ptr_t;
-		auto rule_if_else() -> ast::stmt_ptr_t;
-		auto rule_expression() -> ast::expr_ptr_t;
-		auto rule_assignment() -> ast::expr_ptr_t;
-		auto rule_disjunction() -> ast::expr_ptr_t;
-		auto rule_conjunction() -> ast::expr_ptr_t;
-		auto rule_inversion() -> ast::expr_ptr_t;
-		auto rule_comparison() -> ast::expr_ptr_t;
-		auto raw_sum() -> ast::expr_ptr_t;
-		auto rule_sum() -> ast::expr_ptr_t;
-		auto raw_term() -> ast::expr_ptr_t;
-		auto rule_term() -> ast::expr_ptr_t;
-		auto rule_factor() -> ast::expr_ptr_t;
-		auto rule_power() -> ast::expr_ptr_t;
-		auto raw_primary() -> ast::expr_ptr_t;
-		auto rule_primary() -> ast::expr_ptr_t;
-		auto rule_atom() -> ast::expr_ptr_t;
-		auto rule_expression_commas() -> ast::expr_seq_ptr_t;
-		auto rule_arguments() -> ast::expr_seq_ptr_t;
-		auto rule_vector() -> ast::expr_ptr_t;
-		auto rule_or_conjunction() -> ast::expr_seq_ptr_t;
-		auto rule_and_inversion() -> ast::expr_seq_ptr_t;
-		auto rule_slice() -> ast::expr_ptr_t;
+		auto expect_token(token_type_e type, token_t& token) -> bool;
+		auto require_token(token_type_e type) -> bool;
+		auto record_expected(token_type_e type, size_t mark) -> void;
+		auto peek_token(size_t ahead = 0) -> token_type_e;
+		auto token_text(const token_t& token) const -> std::string_view;
+		auto list_from(size_t base) -> ast::range_t;
+
+		auto is_memoized(int type, ast::expr_id_t& pres) -> bool;
+		auto store_memo(size_t mark, int type, ast::expr_id_t node) -> bool;
+
+		auto rule_statements() -> bool;
+		auto rule_statement() -> ast::stmt_id_t;
+		auto rule_simple_statement() -> ast::stmt_id_t;
+		auto rule_if_else() -> ast::stmt_id_t;
+		auto rule_expression() -> ast::expr_id_t;
+		auto rule_assignment() -> ast::expr_id_t;
+		auto rule_disjunction() -> ast::expr_id_t;
+		auto rule_conjunction() -> ast::expr_id_t;
+		auto rule_inversion() -> ast::expr_id_t;
+		auto rule_comparison() -> ast::expr_id_t;
+		auto raw_sum() -> ast::expr_id_t;
+		auto rule_sum() -> ast::expr_id_t;
+		auto raw_term() -> ast::expr_id_t;
+		auto rule_term() -> ast::expr_id_t;
+		auto rule_factor() -> ast::expr_id_t;
+		auto rule_power() -> ast::expr_id_t;
+		auto raw_primary() -> ast::expr_id_t;
+		auto rule_primary() -> ast::expr_id_t;
+		auto rule_atom() -> ast::expr_id_t;
+		auto rule_expression_commas(ast::expr_seq_t& elements) -> bool;
+		auto rule_arguments(ast::expr_seq_t& elements) -> bool;
+		auto rule_vector() -> ast::expr_id_t;
+		auto rule_or_conjunction(ast::expr_seq_t& elements) -> bool;
+		auto rule_and_inversion(ast::expr_seq_t& elements) -> bool;
+		auto rule_slice() -> ast::expr_id_t;
+
+		auto fast_expression() -> ast::expr_id_t;
+		auto fast_disjunction() -> ast::expr_id_t;
+		auto fast_conjunction() -> ast::expr_id_t;
+		auto fast_inversion() -> ast::expr_id_t;
+		auto fast_binary(int min_precedence) -> ast::expr_id_t;
+		auto fast_factor() -> ast::expr_id_t;
+		auto fast_power() -> ast::expr_id_t;
+		auto fast_primary() -> ast::expr_id_t;
+		auto fast_expressions(ast::range_t& range) -> bool;
 	private:
+		// Collects the reach and missing token of one memoized rule apart from the rest of the parse, so its entry holds
+		// only what depends on the tokens the rule covers, then merges them back in
+		struct rule_scope_t
+		{
+			rule_scope_t(parser_t& parser);
+			~rule_scope_t();
+
+			parser_t& parser;
+			size_t reach;
+			size_t expected_mark;
+			token_type_e expected;
+		};
+
 		tokenizer_t m_tokenizer;
-		std::vector<token_ptr_t> m_tokens;
+		std::vector<token_t> m_tokens;
+		std::vector<memo_t> m_memos;	// One row of memo_type::count entries per token
+		std::vector<ast::expr_id_t> m_list_stack;	// Children of the lists the fast path is still collecting
+		ast::tree_t m_tree;
 
 		size_t m_mark = 0;
+		size_t m_reach = 0;
+		size_t m_expected_mark = 0;
+		token_type_e m_expected = TOK_UNKNOWN;
 	};
 
 }
\ No newline at end of file
@@ -1,11 +1,59 @@
 #pragma once
 
 #include "exprcpp/function.hpp"
+#include "exprcpp/interner.hpp"
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <span>
 #include <string>
-#include <unordered_map>
+#include <string_view>
+#include <type_traits>
+#include <vector>
 
 namespace exprcpp
 {
+
+	namespace internal
+	{
+
+		namespace symbol_kind
+		{
+			const uint8_t none	   = 0;
+			const uint8_t constant = 1;
+			const uint8_t variable = 2;	// Bound to a value the caller owns
+			const uint8_t dynamic  = 4;	// Variable the table owns, added by an assignment or by value
+			const uint8_t function = 8;
+			const uint8_t value	   = constant | variable | dynamic;
+		}
+
+		// A name can be a function and a value at once, so the kind is a set of flags
+		template<typename T>
+		struct symbol_t
+		{
+			string_id_t id = invalid_string_id;
+			uint8_t kind = symbol_kind::none;
+			uint32_t value = 0;		// Index of an owned constant or dynamic variable
+			uint32_t generation = 0;	// Index of the counter set and touch advance
+			T* variable = nullptr;
+			function_t<T>* function = nullptr;
+		};
+
+		// What one name or call node of a tree was bound to, so evaluation reads a slot instead of probing the scopes
+		template<typename T>
+		struct binding_t
+		{
+			const T* value = nullptr;		// Loaded value, possibly in an outer scope
+			const uint64_t* generation = nullptr;	// Advances whenever the loaded value is marked changed
+			T* target = nullptr;			// Assigned value, always in the innermost scope
+			function_t<T>* function = nullptr;
+			const T* folded = nullptr;	// Result known once bound, the node is not evaluated
+			uint32_t memo = 0;			// One past the slot shared by identical pure calls, 0 when there is none
+			uint32_t order = 0;			// One past where a reordered boolean chain starts, 0 to keep the written order
+		};
+
+	}
+
 	template<typename T>
 	class symbol_table_t
 	{
@@ -13,32 +61,108 @@ namespace exprcpp
 		typedef function_t<T>* function_ptr_t;
 
 		symbol_table_t();
+		// Opens a scope over a parent that is never modified through it. Names added here shadow the parent's,
+		// so a shared global table can sit under per-thread bindings and per-expression locals
+		explicit symbol_table_t(std::shared_ptr<const symbol_table_t> parent);
+		symbol_table_t(const symbol_table_t&) = default;
+		symbol_table_t(symbol_table_t&&) noexcept = default;
 		~symbol_table_t() = default;
 
+		auto operator=(const symbol_table_t&) -> symbol_table_t& = default;
+		auto operator=(symbol_table_t&&) noexcept -> symbol_table_t& = default;
+
 		auto add_constants() -> void;
-		auto add_constant(const std::string& name, const T& value) -> bool;
-		auto add_variable(const std::string& name, const T& value) -> bool;
-		auto add_variable(const std::string& name, T* variable) -> bool;
-		auto add_function(const std::string& name, function_ptr_t func) -> bool;
-
-		inline auto has(const std::string& name) const -> bool;
-		inline auto has_constant(const std::string& name) const -> bool;
-		inline auto has_variable(const std::string& name) const -> bool;
-		inline auto has_function(const std::string& name) const -> bool;
-
-		inline auto get_constant(const std::string& name) -> T&;
-		inline auto get_variable(const std::string& name) -> T&;
-		inline auto get_function(const std::string& name) -> function_t<T>*;
-
-		inline auto operator[](const std::string& name) const -> const T&;
-		inline auto operator[](const std::string& name) -> T&;
+		auto add_constant(std::string_view name, const T& value) -> bool;
+		auto add_variable(std::string_view name, const T& value) -> bool;
+		auto add_variable(std::string_view name, T* variable) -> bool;
+		// Binds each name to the value at the same position, all sharing one change counter. Adds none if any fails
+		auto add_variables(std::span<const std::string> names, T* variables) -> bool;
+		// Same over storage the table keeps alive, so whoever handed it over may free its own reference first
+		auto add_variables(std::span<const std::string> names, std::shared_ptr<T[]> variables) -> bool;
+		auto add_function(std::string_view name, function_ptr_t func) -> bool;
+		// Takes any callable by value and deduces its arity from its parameters. One taking std::span<const T> is
+		// variadic. The table owns it, and copies of the table share it
+		template<typename F>
+			requires (!std::is_convertible_v<F, function_t<T>*>)
+		auto add_function(std::string_view name, F&& func, const function_info_t<T>& info = function_info_t<T>()) -> bool;
+
+		inline auto has(std::string_view name) const -> bool;
+		inline auto has_constant(std::string_view name) const -> bool;
+		inline auto has_variable(std::string_view name) const -> bool;
+		inline auto has_function(std::string_view name) const -> bool;
+
+		inline auto get_constant(std::string_view name) -> T&;
+		inline auto get_variable(std::string_view name) -> T&;
+		inline auto get_function(std::string_view name) -> function_t<T>*;
+
+		inline auto operator[](std::string_view name) const -> const T&;
+		inline auto operator[](std::string_view name) -> T&;
+
+		// Lookups by interned id, no hashing of the name text. An id the table does not hold yet must be held by the caller
+		// while it is added, as one from internal::interned_t or another table is
+		inline auto has(internal::string_id_t name) const -> bool;
+		inline auto has_constant(internal::string_id_t name) const -> bool;
+		inline auto has_variable(internal::string_id_t name) const -> bool;
+		inline auto has_function(internal::string_id_t name) const -> bool;
+
+		inline auto get_constant(internal::string_id_t name) -> T&;
+		inline auto get_variable(internal::string_id_t name) -> T&;
+		inline auto get_function(internal::string_id_t name) const -> function_t<T>*;
+
+		// The value a name loads from the innermost scope that has it, preferring variables over constants
+		inline auto resolve(internal::string_id_t name) const -> const T*;
+		// Same as resolve but only looks in this scope, which is the one assignments write to
+		inline auto find(internal::string_id_t name) -> T*;
+
+		inline auto operator[](internal::string_id_t name) -> T&;
+
+		// Writes to a variable that lives in this scope and marks it changed. Values written through the caller's
+		// own pointer are only seen by cached results once touched
+		auto set(std::string_view name, const T& value) -> bool;
+		auto set(internal::string_id_t name, const T& value) -> bool;
+		auto touch(std::string_view name) -> bool;
+		auto touch(internal::string_id_t name) -> bool;
+		// Counter of the value a name loads, in the scope that provides it
+		inline auto generation(internal::string_id_t name) const -> const uint64_t*;
+
+		auto size() const -> size_t;
+		auto parent() const -> const std::shared_ptr<const symbol_table_t>&;
+		// Moves this scope onto another parent, as when a reader pins a newer published version of the globals
+		auto set_parent(std::shared_ptr<const symbol_table_t> parent) -> void;
+		// Grows whenever a name is added to or changes kind in any scope, bindings taken at an older version are stale
+		auto layout_version() const -> uint64_t;
+		// Grows whenever a value in any scope is set or touched
+		auto change_version() const -> uint64_t;
+		// Same for this scope alone, not counting the parents'
+		auto local_change_version() const -> uint64_t;
+		// Visits the counter of each value set or touched in this scope after its local change version was since, oldest
+		// first. Returns false without visiting any when more changes were made than the table remembers
+		template<typename F>
+		auto visit_changes(uint64_t since, F&& visit) const -> bool;
 	private:
 		static auto add_functions(symbol_table_t& symbol_table) -> void;
+
+		inline auto local(internal::string_id_t name) const -> const T*;
+		inline auto slot(internal::string_id_t name) const -> size_t;
+		inline auto find_symbol(internal::string_id_t name) const -> const internal::symbol_t<T>*;
+		inline auto find_symbol(internal::string_id_t name) -> internal::symbol_t<T>*;
+		auto insert_symbol(internal::string_id_t name) -> internal::symbol_t<T>&;
+		auto owned_value(internal::symbol_t<T>& symbol, uint8_t kind, const T& value) -> T&;
+		auto rehash(size_t slots) -> void;
 	private:
-		std::unordered_map<std::string, T> m_constants;
-		std::unordered_map<std::string, T> m_dynamic;
-		std::unordered_map<std::string, T*> m_variables;
-		std::unordered_map<std::string, function_ptr_t> m_functions;
+		std::vector<internal::symbol_t<T>> m_symbols;	// Open addressing with linear probing, an invalid id marks an empty slot
+		size_t m_size = 0;
+		size_t m_shift = 0;
+		std::deque<T> m_values;	// Owned values keep their address while the slots are rehashed
+		std::deque<uint64_t> m_generations;
+		std::vector<std::shared_ptr<function_t<T>>> m_functions;	// Callables added by value
+		std::vector<std::shared_ptr<T[]>> m_frames;	// Values added as shared storage, copies of the table share them
+		std::shared_ptr<const symbol_table_t> m_parent;
+		internal::string_refs_t m_names;	// Keeps the id of every name in the table from being reused
+		uint64_t m_version = 0;
+		uint64_t m_changes = 0;
+		std::vector<uint32_t> m_changed;	// Counter of each recent change, the n-th change since the first is at n modulo its capacity
+		T m_discard = T();	// Handed out for a name the interner had no room for, writes to it are lost
 	};
 
 }
@@ -1,5 +1,10 @@
 #include "symbol_table.hpp"
 
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <iterator>
+
 #define _USE_MATH_DEFINES
 #include <math.h>
 
@@ -8,7 +13,7 @@ namespace exprcpp
     namespace constants
     {
 
-        const std::vector<std::string> keywords =
+        const std::string_view keywords[] =
         {
             "in",
             "not",
@@ -16,14 +21,43 @@ namespace exprcpp
             "else"
         };
 
+        const size_t symbol_table_slots = 64;
+        const size_t change_log_size = 1024;
+
+    }
+
+    namespace internal
+    {
+
+        inline auto is_keyword(std::string_view name) -> bool
+        {
+            return std::find(std::begin(constants::keywords), std::end(constants::keywords), name) != std::end(constants::keywords);
+        }
+
+        // Versions are drawn from one clock shared by every table, so a scope moved onto another parent never
+        // reports a version it reported before
+        inline auto next_version() -> uint64_t
+        {
+            static std::atomic<uint64_t> clock(0);
+            return clock.fetch_add(1, std::memory_order_relaxed) + 1;
+        }
+
     }
 
     template<typename T>
     symbol_table_t<T>::symbol_table_t()
     {
+        rehash(constants::symbol_table_slots);
         add_functions(*this);
     }
 
+    template<typename T>
+    symbol_table_t<T>::symbol_table_t(std::shared_ptr<const symbol_table_t> parent)
+        : m_parent(std::move(parent))
+    {
+        rehash(constants::symbol_table_slots);
+    }
+
     template<typename T>
     auto symbol_table_t<T>::add_constants() -> void
     {
@@ -39,117 +73,606 @@ namespace exprcpp
     }
 
     template<typename T>
-    auto symbol_table_t<T>::add_constant(const std::string& name, const T& value) -> bool
+    auto symbol_table_t<T>::add_constant(std::string_view name, const T& value) -> bool
     {
-        if (has(name))
+        if (internal::is_keyword(name))
         {
             return false;
         }
-        m_constants[name] = value;
-        return false;
+        const internal::interned_t interned(name);
+        const auto id = interned.id();
+        if (id == internal::invalid_string_id)
+        {
+            return false;
+        }
+        auto& symbol = insert_symbol(id);
+        if (symbol.kind & internal::symbol_kind::value)
+        {
+            return false;
+        }
+        owned_value(symbol, internal::symbol_kind::constant, value);
+        return true;
     }
 
     template<typename T>
-    auto symbol_table_t<T>::add_variable(const std::string& name, const T& value) -> bool
+    auto symbol_table_t<T>::add_variable(std::string_view name, const T& value) -> bool
     {
-        if (has(name))
+        if (internal::is_keyword(name))
         {
             return false;
         }
-        m_dynamic[name] = value;
-        return false;
+        const internal::interned_t interned(name);
+        const auto id = interned.id();
+        if (id == internal::invalid_string_id)
+        {
+            return false;
+        }
+        auto& symbol = insert_symbol(id);
+        if (symbol.kind & internal::symbol_kind::value)
+        {
+            return false;
+        }
+        owned_value(symbol, internal::symbol_kind::dynamic, value);
+        return true;
     }
 
     template<typename T>
-    auto symbol_table_t<T>::add_variable(const std::string& name, T* variable) -> bool
+    auto symbol_table_t<T>::add_variable(std::string_view name, T* variable) -> bool
     {
-        if (has(name) || variable == nullptr)
+        if (internal::is_keyword(name) || variable == nullptr)
         {
             return false;
         }
-        m_variables[name] = variable;
+        const internal::interned_t interned(name);
+        const auto id = interned.id();
+        if (id == internal::invalid_string_id)
+        {
+            return false;
+        }
+        auto& symbol = insert_symbol(id);
+        if (symbol.kind & internal::symbol_kind::value)
+        {
+            return false;
+        }
+        symbol.kind |= internal::symbol_kind::variable;
+        symbol.variable = variable;
+        m_version = internal::next_version();
+        return true;
+    }
+
+    template<typename T>
+    auto symbol_table_t<T>::add_variables(std::span<const std::string> names, T* variables) -> bool
+    {
+        if (variables == nullptr && !names.empty())
+        {
+            return false;
+        }
+
+        // Held until inserted, so no id is freed and reused for another name in between
+        std::deque<internal::interned_t> ids;
+        for (const auto& name : names)
+        {
+            if (internal::is_keyword(name))
+            {
+                return false;
+            }
+            const auto id = ids.emplace_back(name).id();
+            const auto symbol = find_symbol(id);
+            if (id == internal::invalid_string_id || (symbol != nullptr && (symbol->kind & internal::symbol_kind::value)))
+            {
+                return false;
+            }
+        }
+
+        std::vector<internal::string_id_t> sorted;
+        std::transform(ids.begin(), ids.end(), std::back_inserter(sorted), [](const auto& id) { return id.id(); });
+        std::sort(sorted.begin(), sorted.end());
+        if (std::adjacent_find(sorted.begin(), sorted.end()) != sorted.end())
+        {
+            return false;
+        }
+
+        // They are written together, so one counter marks them all changed
+        const auto generation = static_cast<uint32_t>(m_generations.size());
+        m_generations.push_back(0);
+        for (size_t n = 0; n < ids.size(); n++)
+        {
+            auto& symbol = insert_symbol(ids[n].id());
+            symbol.kind |= internal::symbol_kind::variable;
+            symbol.variable = variables + n;
+            symbol.generation = generation;
+        }
+        m_version = internal::next_version();
+        return true;
+    }
+
+    template<typename T>
+    auto symbol_table_t<T>::add_variables(std::span<const std::string> names, std::shared_ptr<T[]> variables) -> bool
+    {
+        if (!add_variables(names, variables.get()))
+        {
+            return false;
+        }
+        m_frames.push_back(std::move(variables));
         return true;
     }
 
     template<typename T>
-    auto symbol_table_t<T>::add_function(const std::string& name, function_ptr_t func) -> bool
+    auto symbol_table_t<T>::add_function(std::string_view name, function_ptr_t func) -> bool
     {
-        if (m_functions.find(name) != m_functions.end())
+        const internal::interned_t interned(name);
+        const auto id = interned.id();
+        if (id == internal::invalid_string_id)
+        {
+            return false;
+        }
+        auto& symbol = insert_symbol(id);
+        if (symbol.kind & internal::symbol_kind::function)
         {
             return false;
         }
-        m_functions[name] = func;
+        symbol.kind |= internal::symbol_kind::function;
+        symbol.function = func;
+        m_version = internal::next_version();
         return true;
     }
 
     template<typename T>
-    auto symbol_table_t<T>::has(const std::string& name) const -> bool
+    template<typename F>
+        requires (!std::is_convertible_v<F, function_t<T>*>)
+    auto symbol_table_t<T>::add_function(std::string_view name, F&& func, const function_info_t<T>& info) -> bool
     {
-        return std::count(constants::keywords.begin(), constants::keywords.end(), name) > 0 ||
-               has_constant(name) || has_variable(name);
+        const internal::interned_t interned(name);
+        const auto id = interned.id();
+        const auto symbol = find_symbol(id);
+        if (id == internal::invalid_string_id || (symbol != nullptr && (symbol->kind & internal::symbol_kind::function)))
+        {
+            return false;
+        }
+
+        auto function = std::make_shared<internal::callable_function_t<T, std::decay_t<F>>>(std::forward<F>(func), info);
+        m_functions.push_back(function);
+        return add_function(name, function.get());
     }
 
     template<typename T>
-    auto symbol_table_t<T>::has_constant(const std::string& name) const -> bool
+    auto symbol_table_t<T>::has(std::string_view name) const -> bool
     {
-        return m_constants.find(name) != m_constants.end();
+        return internal::is_keyword(name) || has(internal::global_interner().find(name));
     }
 
     template<typename T>
-    auto symbol_table_t<T>::has_variable(const std::string& name) const -> bool
+    auto symbol_table_t<T>::has_constant(std::string_view name) const -> bool
     {
-        return m_variables.find(name) != m_variables.end() || m_dynamic.find(name) != m_dynamic.end();
+        return has_constant(internal::global_interner().find(name));
     }
 
     template<typename T>
-    inline auto symbol_table_t<T>::has_function(const std::string& name) const -> bool
+    auto symbol_table_t<T>::has_variable(std::string_view name) const -> bool
     {
-        return m_functions.find(name) != m_functions.end();
+        return has_variable(internal::global_interner().find(name));
     }
 
     template<typename T>
-    inline auto symbol_table_t<T>::get_constant(const std::string& name) -> T&
+    inline auto symbol_table_t<T>::has_function(std::string_view name) const -> bool
     {
-        return m_constants[name];
+        return has_function(internal::global_interner().find(name));
     }
 
     template<typename T>
-    inline auto symbol_table_t<T>::get_variable(const std::string& name) -> T&
+    inline auto symbol_table_t<T>::get_constant(std::string_view name) -> T&
     {
-        if (m_variables.find(name) != m_variables.end())
+        const internal::interned_t interned(name);
+        return get_constant(interned.id());
+    }
+
+    template<typename T>
+    inline auto symbol_table_t<T>::get_variable(std::string_view name) -> T&
+    {
+        const internal::interned_t interned(name);
+        return get_variable(interned.id());
+    }
+
+    template<typename T>
+    inline auto symbol_table_t<T>::get_function(std::string_view name) -> function_t<T>*
+    {
+        return get_function(internal::global_interner().find(name));
+    }
+
+    template<typename T>
+    inline auto symbol_table_t<T>::operator[](std::string_view name) const -> const T&
+    {
+        static const T none = T();
+        if (const auto value = resolve(internal::global_interner().find(name)))
         {
-            return *m_variables[name];
+            return *value;
         }
-        return m_dynamic[name];
+        return none;
     }
 
     template<typename T>
-    inline auto symbol_table_t<T>::get_function(const std::string& name) -> function_t<T>*
+    inline auto symbol_table_t<T>::operator[](std::string_view name) -> T&
     {
+        const internal::interned_t interned(name);
+        return (*this)[interned.id()];
+    }
 
-        return m_functions[name];
+    template<typename T>
+    inline auto symbol_table_t<T>::has(internal::string_id_t name) const -> bool
+    {
+        return resolve(name) != nullptr;
     }
 
     template<typename T>
-    inline auto symbol_table_t<T>::operator[](const std::string& name) const -> const T&
+    inline auto symbol_table_t<T>::has_constant(internal::string_id_t name) const -> bool
     {
-        if (has_variable(name))
+        // The innermost scope holding a value decides what kind of value the name is
+        for (auto table = this; table != nullptr; table = table->m_parent.get())
         {
-            return get_variable(name);
+            const auto symbol = table->find_symbol(name);
+            if (symbol != nullptr && (symbol->kind & internal::symbol_kind::value))
+            {
+                return (symbol->kind & internal::symbol_kind::constant) != 0;
+            }
         }
-        return get_constant(name);
+        return false;
+    }
+
+    template<typename T>
+    inline auto symbol_table_t<T>::has_variable(internal::string_id_t name) const -> bool
+    {
+        for (auto table = this; table != nullptr; table = table->m_parent.get())
+        {
+            const auto symbol = table->find_symbol(name);
+            if (symbol != nullptr && (symbol->kind & internal::symbol_kind::value))
+            {
+                return (symbol->kind & (internal::symbol_kind::variable | internal::symbol_kind::dynamic)) != 0;
+            }
+        }
+        return false;
+    }
+
+    template<typename T>
+    inline auto symbol_table_t<T>::has_function(internal::string_id_t name) const -> bool
+    {
+        return get_function(name) != nullptr;
+    }
+
+    template<typename T>
+    inline auto symbol_table_t<T>::get_constant(internal::string_id_t name) -> T&
+    {
+        if (name == internal::invalid_string_id)
+        {
+            return m_discard;
+        }
+        auto& symbol = insert_symbol(name);
+        if (symbol.kind & (internal::symbol_kind::constant | internal::symbol_kind::dynamic))
+        {
+            return m_values[symbol.value];
+        }
+        return owned_value(symbol, internal::symbol_kind::constant, T());
+    }
+
+    template<typename T>
+    inline auto symbol_table_t<T>::get_variable(internal::string_id_t name) -> T&
+    {
+        if (name == internal::invalid_string_id)
+        {
+            return m_discard;
+        }
+        auto& symbol = insert_symbol(name);
+        if (symbol.kind & internal::symbol_kind::variable)
+        {
+            return *symbol.variable;
+        }
+        if (symbol.kind & (internal::symbol_kind::constant | internal::symbol_kind::dynamic))
+        {
+            return m_values[symbol.value];
+        }
+        return owned_value(symbol, internal::symbol_kind::dynamic, T());
+    }
+
+    template<typename T>
+    inline auto symbol_table_t<T>::get_function(internal::string_id_t name) const -> function_t<T>*
+    {
+        for (auto table = this; table != nullptr; table = table->m_parent.get())
+        {
+            const auto symbol = table->find_symbol(name);
+            if (symbol != nullptr && symbol->function != nullptr)
+            {
+                return symbol->function;
+            }
+        }
+        return nullptr;
+    }
+
+    template<typename T>
+    inline auto symbol_table_t<T>::resolve(internal::string_id_t name) const -> const T*
+    {
+        for (auto table = this; table != nullptr; table = table->m_parent.get())
+        {
+            if (const auto value = table->local(name))
+            {
+                return value;
+            }
+        }
+        return nullptr;
+    }
+
+    template<typename T>
+    inline auto symbol_table_t<T>::find(internal::string_id_t name) -> T*
+    {
+        return const_cast<T*>(local(name));
     }
 
     template<typename T>
-    inline auto symbol_table_t<T>::operator[](const std::string& name) -> T&
+    inline auto symbol_table_t<T>::operator[](internal::string_id_t name) -> T&
     {
-        if (has_variable(name))
+        if (const auto value = find(name))
         {
-            return get_variable(name);
+            return *value;
+        }
+
+        // A name from an outer scope is copied into this one, writes never reach the parent
+        if (const auto value = resolve(name))
+        {
+            return owned_value(insert_symbol(name), internal::symbol_kind::dynamic, *value);
         }
         return get_constant(name);
     }
 
+    template<typename T>
+    auto symbol_table_t<T>::set(std::string_view name, const T& value) -> bool
+    {
+        return set(internal::global_interner().find(name), value);
+    }
+
+    template<typename T>
+    auto symbol_table_t<T>::set(internal::string_id_t name, const T& value) -> bool
+    {
+        const auto target = find(name);
+        if (target == nullptr)
+        {
+            return false;
+        }
+        *target = value;
+        return touch(name);
+    }
+
+    template<typename T>
+    auto symbol_table_t<T>::touch(std::string_view name) -> bool
+    {
+        return touch(internal::global_interner().find(name));
+    }
+
+    template<typename T>
+    auto symbol_table_t<T>::touch(internal::string_id_t name) -> bool
+    {
+        const auto symbol = find_symbol(name);
+        if (symbol == nullptr || !(symbol->kind & internal::symbol_kind::value))
+        {
+            return false;
+        }
+        m_generations[symbol->generation] = ++m_changes;
+        const size_t at = (m_changes - 1) % constants::change_log_size;
+        if (at == m_changed.size())
+        {
+            m_changed.push_back(symbol->generation);
+        }
+        else
+        {
+            m_changed[at] = symbol->generation;
+        }
+        return true;
+    }
+
+    template<typename T>
+    inline auto symbol_table_t<T>::generation(internal::string_id_t name) const -> const uint64_t*
+    {
+        for (auto table = this; table != nullptr; table = table->m_parent.get())
+        {
+            const auto symbol = table->find_symbol(name);
+            if (symbol != nullptr && (symbol->kind & internal::symbol_kind::value))
+            {
+                return &table->m_generations[symbol->generation];
+            }
+        }
+        return nullptr;
+    }
+
+    template<typename T>
+    auto symbol_table_t<T>::size() const -> size_t
+    {
+        return m_size;
+    }
+
+    template<typename T>
+    auto symbol_table_t<T>::parent() const -> const std::shared_ptr<const symbol_table_t>&
+    {
+        return m_parent;
+    }
+
+    template<typename T>
+    auto symbol_table_t<T>::set_parent(std::shared_ptr<const symbol_table_t> parent) -> void
+    {
+        if (parent == m_parent)
+        {
+            return;
+        }
+        m_parent = std::move(parent);
+        m_version = internal::next_version();
+    }
+
+    template<typename T>
+    auto symbol_table_t<T>::layout_version() const -> uint64_t
+    {
+        // Every change takes a fresh version from the shared clock, so the newest over the scopes moves whenever any one does
+        uint64_t version = 0;
+        for (auto table = this; table != nullptr; table = table->m_parent.get())
+        {
+            version = std::max(version, table->m_version);
+        }
+        return version;
+    }
+
+    template<typename T>
+    auto symbol_table_t<T>::change_version() const -> uint64_t
+    {
+        uint64_t changes = 0;
+        for (auto table = this; table != nullptr; table = table->m_parent.get())
+        {
+            changes += table->m_changes;
+        }
+        return changes;
+    }
+
+    template<typename T>
+    auto symbol_table_t<T>::local_change_version() const -> uint64_t
+    {
+        return m_changes;
+    }
+
+    template<typename T>
+    template<typename F>
+    auto symbol_table_t<T>::visit_changes(uint64_t since, F&& visit) const -> bool
+    {
+        if (since > m_changes || m_changes - since > m_changed.size())
+        {
+            return false;
+        }
+        for (uint64_t n = since; n < m_changes; n++)
+        {
+            visit(&m_generations[m_changed[n % constants::change_log_size]]);
+        }
+        return true;
+    }
+
+    template<typename T>
+    inline auto symbol_table_t<T>::local(internal::string_id_t name) const -> const T*
+    {
+        const auto symbol = find_symbol(name);
+        if (symbol == nullptr)
+        {
+            return nullptr;
+        }
+        if (symbol->kind & internal::symbol_kind::variable)
+        {
+            return symbol->variable;
+        }
+        if (symbol->kind & (internal::symbol_kind::constant | internal::symbol_kind::dynamic))
+        {
+            return &m_values[symbol->value];
+        }
+        return nullptr;
+    }
+
+    template<typename T>
+    inline auto symbol_table_t<T>::slot(internal::string_id_t name) const -> size_t
+    {
+        // Fibonacci hashing spreads the dense interned ids over the high bits
+        return static_cast<size_t>((uint64_t(name) * 0x9E3779B97F4A7C15ull) >> m_shift);
+    }
+
+    template<typename T>
+    inline auto symbol_table_t<T>::find_symbol(internal::string_id_t name) const -> const internal::symbol_t<T>*
+    {
+        if (name == internal::invalid_string_id)
+        {
+            return nullptr;
+        }
+
+        const size_t mask = m_symbols.size() - 1;
+        for (size_t n = slot(name);; n = (n + 1) & mask)
+        {
+            const auto& symbol = m_symbols[n];
+            if (symbol.id == name)
+            {
+                return &symbol;
+            }
+            if (symbol.id == internal::invalid_string_id)
+            {
+                return nullptr;
+            }
+        }
+    }
+
+    template<typename T>
+    inline auto symbol_table_t<T>::find_symbol(internal::string_id_t name) -> internal::symbol_t<T>*
+    {
+        return const_cast<internal::symbol_t<T>*>(static_cast<const symbol_table_t*>(this)->find_symbol(name));
+    }
+
+    template<typename T>
+    auto symbol_table_t<T>::insert_symbol(internal::string_id_t name) -> internal::symbol_t<T>&
+    {
+        // The invalid id marks empty slots, callers turn it away before getting here
+        assert(name != internal::invalid_string_id);
+
+        // Kept at most three quarters full, so a probe rarely runs past a cache line or two
+        if ((m_size + 1) * 4 > m_symbols.size() * 3)
+        {
+            rehash(m_symbols.size() * 2);
+        }
+
+        const size_t mask = m_symbols.size() - 1;
+        for (size_t n = slot(name);; n = (n + 1) & mask)
+        {
+            auto& symbol = m_symbols[n];
+            if (symbol.id == name)
+            {
+                return symbol;
+            }
+            if (symbol.id == internal::invalid_string_id)
+            {
+                symbol.id = name;
+                m_names.add(name);
+                symbol.generation = static_cast<uint32_t>(m_generations.size());
+                m_generations.push_back(0);
+                m_size++;
+                return symbol;
+            }
+        }
+    }
+
+    template<typename T>
+    auto symbol_table_t<T>::owned_value(internal::symbol_t<T>& symbol, uint8_t kind, const T& value) -> T&
+    {
+        symbol.kind |= kind;
+        symbol.value = static_cast<uint32_t>(m_values.size());
+        m_values.push_back(value);
+        m_version = internal::next_version();
+        return m_values.back();
+    }
+
+    template<typename T>
+    auto symbol_table_t<T>::rehash(size_t slots) -> void
+    {
+        std::vector<internal::symbol_t<T>> symbols(slots);
+        std::swap(symbols, m_symbols);
+
+        size_t bits = 0;
+        while ((size_t(1) << bits) < slots)
+        {
+            bits++;
+        }
+        m_shift = 64 - bits;
+
+        const size_t mask = slots - 1;
+        for (const auto& symbol : symbols)
+        {
+            if (symbol.id == internal::invalid_string_id)
+            {
+                continue;
+            }
+            size_t n = slot(symbol.id);
+            while (m_symbols[n].id != internal::invalid_string_id)
+            {
+                n = (n + 1) & mask;
+            }
+            m_symbols[n] = symbol;
+        }
+    }
+
     template<typename T>
     auto symbol_table_t<T>::add_functions(symbol_table_t& symbol_table) -> void
     {
@@ -1,8 +1,8 @@
 #pragma once
 
-#include "exprcpp/ast.hpp"
-#include <memory>
+#include <cstdint>
 #include <string>
+#include <string_view>
 
 namespace exprcpp::internal
 {
@@ -77,46 +77,44 @@ namespace exprcpp::internal
 		TOK_NT_OFFSET = 256
 	};
 
-	struct memo_t
-	{
-		int type;
-		ast::node_ptr_t node;
-		int mark;
-		std::shared_ptr<memo_t> next;
-	};
-
+	// Refers back into the expression string, which must outlive the tokens
 	struct token_t
 	{
-		std::string value;
-		token_type_e type;
-		std::shared_ptr<memo_t> memo;
+		token_type_e type = TOK_UNKNOWN;
+		uint32_t offset = 0;
+		uint32_t length = 0;
 	};
 
-	typedef std::shared_ptr<token_t> token_ptr_t;
-
 	class tokenizer_t
 	{
 	public:
-		tokenizer_t(const std::string& expression_string);
+		tokenizer_t(std::string_view expression_string);
 		~tokenizer_t() = default;
 
-		auto get() -> token_ptr_t;
+		auto reset(std::string_view expression_string) -> void;
+		auto seek(size_t offset) -> void;
+		auto get() -> token_t;
+		auto text(const token_t& token) const -> std::string_view;
+		auto error() const -> const char*;	// nullptr unless an error token was returned
 	private:
 		auto next() -> char;
 		auto back() -> void;
-		auto back(const std::string::const_iterator& location) -> void;
+		auto back(const std::string_view::const_iterator& location) -> void;
 
-		auto decimal_tail(token_ptr_t& token) -> char;
+		auto make_token(token_type_e type) const -> token_t;
+		auto syntax_error(token_t& token, const char* message) -> void;
+		auto decimal_tail(token_t& token) -> char;
 
 		auto operator_one_char(const char c1) -> token_type_e;
 		auto operator_two_chars(const char c1, const char c2) -> token_type_e;
 		auto operator_three_chars(const char c1, const char c2, const char c3) -> token_type_e;
 	private:
-		const std::string m_expression_string;
+		std::string_view m_expression_string;
+		const char* m_error = nullptr;
 
-		std::string::const_iterator m_start;
-		std::string::const_iterator m_end;
-		std::string::const_iterator m_current;
+		std::string_view::const_iterator m_start;
+		std::string_view::const_iterator m_end;
+		std::string_view::const_iterator m_current;
 
 		bool m_done = false;
 		bool m_first = true;
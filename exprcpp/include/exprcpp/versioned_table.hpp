@@ -0,0 +1,86 @@
+#pragma once
+
+#include "exprcpp/symbol_table.hpp"
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+namespace exprcpp
+{
+
+	namespace constants
+	{
+		const size_t reader_stripes = 16;
+	}
+
+	// Publishes immutable versions of a symbol table while other threads evaluate against them. Readers pin the
+	// current version without locking or sharing a reference count, writers copy it, change the copy and swap it in.
+	// A replaced version is freed once the epoch has advanced twice, which needs every reader pinned before it to leave
+	template<typename T>
+	class versioned_table_t
+	{
+	public:
+		class pin_t
+		{
+		public:
+			pin_t(pin_t&& other) noexcept;
+			pin_t(const pin_t&) = delete;
+			~pin_t();
+
+			auto operator=(pin_t&&) -> pin_t& = delete;
+			auto operator=(const pin_t&) -> pin_t& = delete;
+
+			auto operator*() const -> const symbol_table_t<T>&;
+			auto operator->() const -> const symbol_table_t<T>*;
+			// Refers to the pinned version without owning it, to parent a scope for as long as the pin is held
+			auto table() const -> std::shared_ptr<const symbol_table_t<T>>;
+		private:
+			friend class versioned_table_t;
+			pin_t(std::atomic<uint64_t>* readers, const symbol_table_t<T>* table);
+		private:
+			std::atomic<uint64_t>* m_readers;
+			const symbol_table_t<T>* m_table;
+		};
+
+		explicit versioned_table_t(symbol_table_t<T> table = symbol_table_t<T>());
+		versioned_table_t(const versioned_table_t&) = delete;
+		~versioned_table_t();
+
+		auto operator=(const versioned_table_t&) -> versioned_table_t& = delete;
+
+		auto pin() const -> pin_t;
+
+		// Copies the current version, lets change modify the copy and publishes it. Writers only wait for each other
+		template<typename F>
+		auto update(F&& change) -> void;
+		auto publish(symbol_table_t<T> table) -> void;
+
+		// Frees the replaced versions no reader can still hold, returns how many are left waiting
+		auto reclaim() -> size_t;
+		auto version() const -> uint64_t;
+	private:
+		auto replace(std::unique_ptr<const symbol_table_t<T>> table) -> void;
+		auto collect() -> size_t;
+		auto readers(uint64_t epoch) const -> uint64_t;
+	private:
+		// Each stripe sits on its own cache line so readers on different threads do not share one counter
+		struct alignas(64) stripe_t
+		{
+			std::atomic<uint64_t> readers[2];	// Pinned readers by the parity of the epoch they entered in
+		};
+
+		mutable stripe_t m_stripes[constants::reader_stripes];
+		std::atomic<uint64_t> m_epoch;
+		std::atomic<const symbol_table_t<T>*> m_current;
+		std::atomic<uint64_t> m_version;
+
+		std::mutex m_writer;
+		std::vector<std::pair<uint64_t, const symbol_table_t<T>*>> m_retired;	// Epoch each version was replaced in
+	};
+
+}
+
+#include "versioned_table.inl"
\ No newline at end of file
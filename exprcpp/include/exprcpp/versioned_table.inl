@@ -0,0 +1,176 @@
+#include "versioned_table.hpp"
+
+namespace exprcpp
+{
+
+	namespace internal
+	{
+
+		inline auto reader_stripe() -> size_t
+		{
+			static std::atomic<size_t> next(0);
+			thread_local const size_t stripe = next.fetch_add(1, std::memory_order_relaxed) % exprcpp::constants::reader_stripes;
+			return stripe;
+		}
+
+	}
+
+	template<typename T>
+	versioned_table_t<T>::pin_t::pin_t(std::atomic<uint64_t>* readers, const symbol_table_t<T>* table)
+		: m_readers(readers)
+		, m_table(table)
+	{ }
+
+	template<typename T>
+	versioned_table_t<T>::pin_t::pin_t(pin_t&& other) noexcept
+		: m_readers(std::exchange(other.m_readers, nullptr))
+		, m_table(other.m_table)
+	{ }
+
+	template<typename T>
+	versioned_table_t<T>::pin_t::~pin_t()
+	{
+		if (m_readers)
+		{
+			m_readers->fetch_sub(1, std::memory_order_release);
+		}
+	}
+
+	template<typename T>
+	auto versioned_table_t<T>::pin_t::operator*() const -> const symbol_table_t<T>&
+	{
+		return *m_table;
+	}
+
+	template<typename T>
+	auto versioned_table_t<T>::pin_t::operator->() const -> const symbol_table_t<T>*
+	{
+		return m_table;
+	}
+
+	template<typename T>
+	auto versioned_table_t<T>::pin_t::table() const -> std::shared_ptr<const symbol_table_t<T>>
+	{
+		return std::shared_ptr<const symbol_table_t<T>>(std::shared_ptr<void>(), m_table);
+	}
+
+	template<typename T>
+	versioned_table_t<T>::versioned_table_t(symbol_table_t<T> table)
+		: m_stripes()
+		, m_epoch(0)
+		, m_current(new symbol_table_t<T>(std::move(table)))
+		, m_version(0)
+	{ }
+
+	template<typename T>
+	versioned_table_t<T>::~versioned_table_t()
+	{
+		for (auto& retired : m_retired)
+		{
+			delete retired.second;
+		}
+		delete m_current.load();
+	}
+
+	template<typename T>
+	auto versioned_table_t<T>::pin() const -> pin_t
+	{
+		auto& stripe = m_stripes[internal::reader_stripe()];
+		while (true)
+		{
+			// Announce the reader before loading the version, then make sure no writer advanced past the announcement
+			// in between, since it would not wait for a counter it had already found empty
+			const uint64_t epoch = m_epoch.load();
+			auto& readers = stripe.readers[epoch & 1];
+			readers.fetch_add(1);
+			if (m_epoch.load() == epoch)
+			{
+				return pin_t(&readers, m_current.load());
+			}
+			readers.fetch_sub(1, std::memory_order_release);
+		}
+	}
+
+	template<typename T>
+	template<typename F>
+	auto versioned_table_t<T>::update(F&& change) -> void
+	{
+		std::lock_guard<std::mutex> lock(m_writer);
+		auto table = std::make_unique<symbol_table_t<T>>(*m_current.load());
+		change(*table);
+		replace(std::move(table));
+	}
+
+	template<typename T>
+	auto versioned_table_t<T>::publish(symbol_table_t<T> table) -> void
+	{
+		std::lock_guard<std::mutex> lock(m_writer);
+		replace(std::make_unique<const symbol_table_t<T>>(std::move(table)));
+	}
+
+	template<typename T>
+	auto versioned_table_t<T>::reclaim() -> size_t
+	{
+		std::lock_guard<std::mutex> lock(m_writer);
+		return collect();
+	}
+
+	template<typename T>
+	auto versioned_table_t<T>::version() const -> uint64_t
+	{
+		return m_version.load(std::memory_order_acquire);
+	}
+
+	template<typename T>
+	auto versioned_table_t<T>::replace(std::unique_ptr<const symbol_table_t<T>> table) -> void
+	{
+		const auto previous = m_current.exchange(table.release());
+		m_retired.emplace_back(m_epoch.load(), previous);
+		m_version.fetch_add(1, std::memory_order_release);
+		collect();
+	}
+
+	template<typename T>
+	auto versioned_table_t<T>::collect() -> size_t
+	{
+		// The epoch may advance once the readers of the previous one have left, so their parity can be reused.
+		// A version replaced in epoch e is then out of reach at e + 2, every reader of e and e - 1 having left
+		for (size_t n = 0; n < 2; n++)
+		{
+			const uint64_t epoch = m_epoch.load();
+			if (readers(epoch + 1) != 0)
+			{
+				break;
+			}
+			m_epoch.store(epoch + 1);
+		}
+
+		const uint64_t epoch = m_epoch.load();
+		size_t kept = 0;
+		for (auto& retired : m_retired)
+		{
+			if (retired.first + 2 <= epoch)
+			{
+				delete retired.second;
+			}
+			else
+			{
+				m_retired[kept++] = retired;
+			}
+		}
+		m_retired.resize(kept);
+		return m_retired.size();
+	}
+
+	template<typename T>
+	auto versioned_table_t<T>::readers(uint64_t epoch) const -> uint64_t
+	{
+		uint64_t count = 0;
+		for (auto& stripe : m_stripes)
+		{
+			count += stripe.readers[epoch & 1].load();
+		}
+		return count;
+	}
+
+}
\ No newline at end of file
@@ -0,0 +1,96 @@
+#include "exprcpp/arrow.hpp"
+
+#include <cstring>
+
+namespace exprcpp::arrow
+{
+
+	static auto column_type(const char* format, column_type_e& type) -> bool
+	{
+		if (format == nullptr)
+		{
+			return false;
+		}
+
+		if (std::strcmp(format, "g") == 0)
+		{
+			type = column_type_e::float64;
+			return true;
+		}
+		if (std::strcmp(format, "f") == 0)
+		{
+			type = column_type_e::float32;
+			return true;
+		}
+		if (std::strcmp(format, "l") == 0)
+		{
+			type = column_type_e::int64;
+			return true;
+		}
+		return false;
+	}
+
+	auto import_column(const ArrowSchema& schema, const ArrowArray& array, column_t& column) -> bool
+	{
+		if (array.release == nullptr || array.n_buffers != 2 || array.buffers == nullptr ||
+			schema.dictionary != nullptr || array.length < 0 || array.offset < 0)
+		{
+			return false;
+		}
+
+		if (!column_type(schema.format, column.type) || array.buffers[1] == nullptr)
+		{
+			return false;
+		}
+
+		// The validity buffer may be omitted when the array has no nulls
+		if (array.null_count != 0 && array.buffers[0] == nullptr)
+		{
+			return false;
+		}
+
+		column.data = array.buffers[1];
+		column.validity = array.null_count == 0 ? nullptr : static_cast<const uint8_t*>(array.buffers[0]);
+		column.offset = static_cast<size_t>(array.offset);
+		column.length = static_cast<size_t>(array.length);
+		return true;
+	}
+
+	auto bind_column(batch_t& batch, const std::string& name, const ArrowSchema& schema, const ArrowArray& array) -> bool
+	{
+		column_t column;
+		if (!import_column(schema, array, column))
+		{
+			return false;
+		}
+		return batch.add_column(name, column);
+	}
+
+	auto bind_record_batch(batch_t& batch, const ArrowSchema& schema, const ArrowArray& array) -> bool
+	{
+		if (schema.format == nullptr || std::strcmp(schema.format, "+s") != 0 ||
+			array.release == nullptr || schema.n_children != array.n_children)
+		{
+			return false;
+		}
+
+		// Struct level nulls and offsets would have to be merged into every child
+		if (array.null_count != 0 || array.offset != 0)
+		{
+			return false;
+		}
+
+		for (int64_t i = 0; i < schema.n_children; i++)
+		{
+			const auto child_schema = schema.children[i];
+			const auto child_array = array.children[i];
+			if (child_schema == nullptr || child_array == nullptr || child_schema->name == nullptr ||
+				!bind_column(batch, child_schema->name, *child_schema, *child_array))
+			{
+				return false;
+			}
+		}
+		return true;
+	}
+
+}
\ No newline at end of file
@@ -2,149 +2,198 @@
 
 namespace exprcpp::internal::ast
 {
-	auto if_else(const expr_ptr_t& condition, const expr_ptr_t& true_case, const expr_ptr_t& false_case) -> stmt_ptr_t
+
+	tree_t::tree_t()
+		: m_statements(1), m_expressions(1)
+	{ }
+
+	auto tree_t::reserve(size_t expressions) -> void
+	{
+		m_expressions.reserve(expressions + 1);
+		m_lists.reserve(expressions);
+	}
+
+	auto tree_t::empty() const -> bool
+	{
+		return m_root.empty();
+	}
+
+	auto tree_t::size() const -> size_t
+	{
+		return m_expressions.size();
+	}
+
+	auto tree_t::statements() const -> const std::vector<stmt_id_t>&
+	{
+		return m_root;
+	}
+
+	auto tree_t::set_statements(std::vector<stmt_id_t> statements) -> void
+	{
+		m_root = std::move(statements);
+	}
+
+	auto tree_t::get_statement(stmt_id_t id) const -> const statement_t&
+	{
+		return m_statements[id];
+	}
+
+	auto tree_t::get_expression(expr_id_t id) const -> const expression_t&
+	{
+		return m_expressions[id];
+	}
+
+	auto tree_t::get_list(const range_t& range) const -> std::span<const expr_id_t>
+	{
+		return std::span<const expr_id_t>(m_lists.data() + range.first, range.count);
+	}
+
+	auto tree_t::get_name(string_id_t id) const -> const std::string&
+	{
+		return m_names[id];
+	}
+
+	auto tree_t::names() const -> const std::vector<std::string>&
+	{
+		return m_names;
+	}
+
+	auto tree_t::get_constant(uint32_t id) const -> const std::string&
+	{
+		return m_constants[id];
+	}
+
+	auto tree_t::if_else(expr_id_t condition, expr_id_t true_case, expr_id_t false_case) -> stmt_id_t
 	{
 		statement_t::stmt_if_else_t if_else;
 		if_else.condition = condition;
 		if_else.true_case = true_case;
 		if_else.false_case = false_case;
 
-		auto stmt = std::make_shared<statement_t>();
-		stmt->kind = statement_kind_e::if_else;
-		stmt->value = if_else;
-		return stmt;
+		auto& stmt = m_statements.emplace_back();
+		stmt.kind = statement_kind_e::if_else;
+		stmt.value = if_else;
+		return static_cast<stmt_id_t>(m_statements.size() - 1);
 	}
 
-	auto expression(const expr_ptr_t& value) -> stmt_ptr_t
+	auto tree_t::expression(expr_id_t value) -> stmt_id_t
 	{
 		statement_t::stmt_expr_t expr;
 		expr.value = value;
 
-		auto stmt = std::make_shared<statement_t>();
-		stmt->kind = statement_kind_e::expr;
-		stmt->value = expr;
-		return stmt;
+		auto& stmt = m_statements.emplace_back();
+		stmt.kind = statement_kind_e::expr;
+		stmt.value = expr;
+		return static_cast<stmt_id_t>(m_statements.size() - 1);
 	}
 
-	auto bool_op(bool_op_type_e op, const expr_seq_ptr_t& values) -> expr_ptr_t
+	auto tree_t::bool_op(bool_op_type_e op, const range_t& values) -> expr_id_t
 	{
 		expression_t::expr_bool_op_t bool_op;
 		bool_op.op = op;
 		bool_op.values = values;
-
-		auto expr = std::make_shared<expression_t>();
-		expr->kind = expression_kind_e::bool_op;
-		expr->value = bool_op;
-		return expr;
+		return add(expression_kind_e::bool_op, bool_op);
 	}
 
-	auto bin_op(const expr_ptr_t& left, operator_type_e op, const expr_ptr_t& right) -> expr_ptr_t
+	auto tree_t::bin_op(expr_id_t left, operator_type_e op, expr_id_t right) -> expr_id_t
 	{
 		expression_t::expr_bin_op_t bin_op;
 		bin_op.left = left;
 		bin_op.op = op;
 		bin_op.right = right;
-
-		auto expr = std::make_shared<expression_t>();
-		expr->kind = expression_kind_e::bin_op;
-		expr->value = bin_op;
-		return expr;
+		return add(expression_kind_e::bin_op, bin_op);
 	}
 
-	auto unary_op(unary_op_type_e op, const expr_ptr_t& right) -> expr_ptr_t
+	auto tree_t::unary_op(unary_op_type_e op, expr_id_t right) -> expr_id_t
 	{
 		expression_t::expr_unary_op_t unary_op;
 		unary_op.op = op;
 		unary_op.right = right;
-
-		auto expr = std::make_shared<expression_t>();
-		expr->kind = expression_kind_e::unary_op;
-		expr->value = unary_op;
-		return expr;
+		return add(expression_kind_e::unary_op, unary_op);
 	}
 
-	auto cmp_op(const expr_ptr_t& left, cmp_op_type_e op, const expr_ptr_t& right) -> expr_ptr_t
+	auto tree_t::cmp_op(expr_id_t left, cmp_op_type_e op, expr_id_t right) -> expr_id_t
 	{
 		expression_t::expr_cmp_op_t cmp_op;
 		cmp_op.left = left;
 		cmp_op.op = op;
 		cmp_op.right = right;
-
-		auto expr = std::make_shared<expression_t>();
-		expr->kind = expression_kind_e::cmp_op;
-		expr->value = cmp_op;
-		return expr;
+		return add(expression_kind_e::cmp_op, cmp_op);
 	}
 
-	auto assign(const std::string& id, const expr_ptr_t& value) -> expr_ptr_t
+	auto tree_t::assign(std::string_view id, expr_id_t value) -> expr_id_t
 	{
 		expression_t::expr_assign_t assign;
-		assign.id = id;
+		assign.id = add_name(id);
 		assign.value = value;
-
-		auto expr = std::make_shared<expression_t>();
-		expr->kind = expression_kind_e::assign;
-		expr->value = assign;
-		return expr;
+		return add(expression_kind_e::assign, assign);
 	}
 
-	auto constant(const std::string& value) -> expr_ptr_t
+	auto tree_t::constant(std::string_view value) -> expr_id_t
 	{
 		expression_t::expr_constant_t constant;
-		constant.value = value;
-
-		auto expr = std::make_shared<expression_t>();
-		expr->kind = expression_kind_e::constant;
-		expr->value = constant;
-		return expr;
+		constant.value = static_cast<uint32_t>(m_constants.size());
+		m_constants.emplace_back(value);
+		return add(expression_kind_e::constant, constant);
 	}
 
-	auto name(const std::string& id, expr_context_type_e context) -> expr_ptr_t
+	auto tree_t::name(std::string_view id, expr_context_type_e context) -> expr_id_t
 	{
 		expression_t::expr_name_t name;
-		name.id = id;
+		name.id = add_name(id);
 		name.context = context;
-
-		auto expr = std::make_shared<expression_t>();
-		expr->kind = expression_kind_e::name;
-		expr->value = name;
-		return expr;
+		return add(expression_kind_e::name, name);
 	}
 
-	auto vector(const expr_seq_ptr_t& elements) -> expr_ptr_t
+	auto tree_t::vector(const range_t& elements) -> expr_id_t
 	{
 		expression_t::expr_vector_t vector;
 		vector.elements = elements;
-
-		auto expr = std::make_shared<expression_t>();
-		expr->kind = expression_kind_e::vector;
-		expr->value = vector;
-		return expr;
+		return add(expression_kind_e::vector, vector);
 	}
 
-	auto call(const std::string& name, const expr_seq_ptr_t& args) -> expr_ptr_t
+	auto tree_t::call(std::string_view name, const range_t& args) -> expr_id_t
 	{
 		expression_t::expr_call_t call;
-		call.name = name;
+		call.name = add_name(name);
 		call.args = args;
-
-		auto expr = std::make_shared<expression_t>();
-		expr->kind = expression_kind_e::call;
-		expr->value = call;
-		return expr;
+		return add(expression_kind_e::call, call);
 	}
 
-	auto slice(const expr_ptr_t& vector, const expr_ptr_t& start, const expr_ptr_t& stop) -> expr_ptr_t
+	auto tree_t::slice(expr_id_t vector, expr_id_t start, expr_id_t stop) -> expr_id_t
 	{
 		expression_t::expr_slice_t slice;
 		slice.vector = vector;
 		slice.start = start;
 		slice.stop = stop;
+		return add(expression_kind_e::slice, slice);
+	}
 
-		auto expr = std::make_shared<expression_t>();
-		expr->kind = expression_kind_e::slice;
-		expr->value = slice;
-		return expr;
+	auto tree_t::list(const expr_id_t* elements, size_t count) -> range_t
+	{
+		range_t range;
+		range.first = static_cast<uint32_t>(m_lists.size());
+		range.count = static_cast<uint32_t>(count);
+		m_lists.insert(m_lists.end(), elements, elements + count);
+		return range;
+	}
+
+	auto tree_t::add(expression_kind_e kind, const decltype(expression_t::value)& value) -> expr_id_t
+	{
+		auto& expr = m_expressions.emplace_back();
+		expr.kind = kind;
+		expr.value = value;
+		return static_cast<expr_id_t>(m_expressions.size() - 1);
+	}
+
+	auto tree_t::add_name(std::string_view name) -> string_id_t
+	{
+		const auto [it, inserted] = m_name_ids.try_emplace(std::string(name), static_cast<string_id_t>(m_names.size()));
+		if (inserted)
+		{
+			m_names.emplace_back(name);
+		}
+		return it->second;
 	}
 
 }
\ No newline at end of file
@@ -0,0 +1,109 @@
+#include "exprcpp/batch.hpp"
+
+#include <algorithm>
+
+namespace exprcpp
+{
+
+	batch_t::batch_t(size_t rows)
+		: m_rows(rows)
+	{ }
+
+	auto batch_t::rows() const -> size_t
+	{
+		return m_rows;
+	}
+
+	auto batch_t::set_tile_size(size_t rows) -> void
+	{
+		m_tile_size = rows;
+	}
+
+	auto batch_t::tile_size() const -> size_t
+	{
+		return m_tile_size;
+	}
+
+	auto batch_t::add_column(const std::string& name, const column_t& column) -> bool
+	{
+		if (column.data == nullptr || column.length < m_rows || has_column(name))
+		{
+			return false;
+		}
+		const internal::interned_t interned(name);
+		if (interned.id() == internal::invalid_string_id)
+		{
+			return false;
+		}
+		m_columns[interned.id()] = column;
+		m_names.add(interned.id());
+		return true;
+	}
+
+	auto batch_t::add_column(const std::string& name, const double* data, const uint8_t* validity) -> bool
+	{
+		column_t column;
+		column.type = column_type_e::float64;
+		column.data = data;
+		column.validity = validity;
+		column.length = m_rows;
+		return add_column(name, column);
+	}
+
+	auto batch_t::add_column(const std::string& name, const float* data, const uint8_t* validity) -> bool
+	{
+		column_t column;
+		column.type = column_type_e::float32;
+		column.data = data;
+		column.validity = validity;
+		column.length = m_rows;
+		return add_column(name, column);
+	}
+
+	auto batch_t::add_column(const std::string& name, const int64_t* data, const uint8_t* validity) -> bool
+	{
+		column_t column;
+		column.type = column_type_e::int64;
+		column.data = data;
+		column.validity = validity;
+		column.length = m_rows;
+		return add_column(name, column);
+	}
+
+	auto batch_t::slice(size_t begin, size_t rows) const -> batch_t
+	{
+		begin = std::min(begin, m_rows);
+		batch_t batch(std::min(rows, m_rows - begin));
+		batch.m_tile_size = m_tile_size;
+		batch.m_names = m_names;
+		for (const auto& [name, column] : m_columns)
+		{
+			auto sliced = column;
+			sliced.offset += begin;
+			sliced.length -= begin;
+			batch.m_columns[name] = sliced;
+		}
+		return batch;
+	}
+
+	auto batch_t::has_column(const std::string& name) const -> bool
+	{
+		return m_columns.find(internal::global_interner().find(name)) != m_columns.end();
+	}
+
+	auto batch_t::get_column(const std::string& name) const -> const column_t*
+	{
+		return get_column(internal::global_interner().find(name));
+	}
+
+	auto batch_t::get_column(internal::string_id_t name) const -> const column_t*
+	{
+		auto it = m_columns.find(name);
+		if (it == m_columns.end())
+		{
+			return nullptr;
+		}
+		return &it->second;
+	}
+
+}
\ No newline at end of file
@@ -0,0 +1,229 @@
+#include "exprcpp/compile.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <thread>
+
+#include "exprcpp/parser.hpp"
+
+namespace exprcpp
+{
+
+	namespace internal
+	{
+
+		namespace constants
+		{
+			const size_t compile_chunk = 64;	// Expressions a worker claims at once, small enough to balance uneven lengths
+			const size_t reparse_garbage = 4;	// Nodes per character an edited tree may grow to before it is rebuilt from scratch
+		}
+
+		inline auto parse_error(const parser_t& parser) -> compile_error_t
+		{
+			const auto failure = parser.failure();
+
+			compile_error_t error;
+			error.offset = failure.token.offset;
+			error.length = failure.token.length;
+			error.expected = failure.expected;
+			error.detail = failure.message;
+			if (failure.token.type == TOK_ERRORTOKEN)
+			{
+				error.code = compile_error_e::invalid_token;
+			}
+			else if (failure.token.type == TOK_ENDMARKER)
+			{
+				error.code = compile_error_e::unexpected_end;
+			}
+			else
+			{
+				error.code = compile_error_e::unexpected_token;
+			}
+			return error;
+		}
+
+		inline auto token_spelling(token_type_e type) -> const char*
+		{
+			switch (type)
+			{
+			case TOK_RPAREN: return ")";
+			case TOK_RSQB: return "]";
+			case TOK_COLON: return ":";
+			default: return nullptr;
+			}
+		}
+
+		inline auto compile_into(parser_t& parser, std::string_view expression_string, compile_result_t& result) -> void
+		{
+			parser.reset(expression_string);
+
+			ast::tree_t tree;
+			if (!parser.compile(tree))
+			{
+				result.tree = nullptr;
+				result.error = parse_error(parser);
+				return;
+			}
+			result.tree = std::make_shared<const ast::tree_t>(std::move(tree));
+			result.error = compile_error_t();
+		}
+
+		template<typename S>
+		auto compile_all(std::span<const S> expression_strings, size_t threads) -> std::vector<compile_result_t>
+		{
+			std::vector<compile_result_t> results(expression_strings.size());
+			if (threads == 0)
+			{
+				threads = std::max<size_t>(std::thread::hardware_concurrency(), 1);
+			}
+			threads = std::min(threads, (expression_strings.size() + constants::compile_chunk - 1) / constants::compile_chunk);
+
+			// Each worker keeps one parser, so token and memo buffers are allocated once per thread
+			std::atomic<size_t> next(0);
+			const auto work = [&]()
+			{
+				parser_t parser("");
+				size_t begin = 0;
+				while ((begin = next.fetch_add(constants::compile_chunk, std::memory_order_relaxed)) < expression_strings.size())
+				{
+					const size_t end = std::min(begin + constants::compile_chunk, expression_strings.size());
+					for (size_t n = begin; n < end; n++)
+					{
+						compile_into(parser, expression_strings[n], results[n]);
+					}
+				}
+			};
+
+			std::vector<std::thread> workers;
+			for (size_t n = 1; n < threads; n++)
+			{
+				workers.emplace_back(work);
+			}
+			work();
+			for (auto& worker : workers)
+			{
+				worker.join();
+			}
+			return results;
+		}
+
+	}
+
+	auto compile_error_t::message(std::string_view expression_string) const -> std::string
+	{
+		auto message = "Failed to parse '" + std::string(expression_string) + "'";
+		switch (code)
+		{
+		case compile_error_e::none:
+			return std::string();
+		case compile_error_e::invalid_token:
+			message += ": ";
+			message += detail != nullptr ? detail : "invalid token";
+			break;
+		case compile_error_e::unexpected_token:
+			message += ": unexpected '";
+			message += expression_string.substr(std::min<size_t>(offset, expression_string.size()), length);
+			message += "'";
+			break;
+		case compile_error_e::unexpected_end:
+			message += ": unexpected end of input";
+			break;
+		}
+		message += " at offset " + std::to_string(offset);
+		if (const auto spelling = internal::token_spelling(expected))
+		{
+			message += ", expected '";
+			message += spelling;
+			message += "'";
+		}
+		return message;
+	}
+
+	auto compile_result_t::ok() const -> bool
+	{
+		return tree != nullptr;
+	}
+
+	auto compile_tree(std::string_view expression_string) -> compile_result_t
+	{
+		internal::parser_t parser(expression_string);
+		compile_result_t result;
+		internal::compile_into(parser, expression_string, result);
+		return result;
+	}
+
+	auto compile_many(std::span<const std::string> expression_strings, size_t threads) -> std::vector<compile_result_t>
+	{
+		return internal::compile_all(expression_strings, threads);
+	}
+
+	auto compile_many(std::span<const std::string_view> expression_strings, size_t threads) -> std::vector<compile_result_t>
+	{
+		return internal::compile_all(expression_strings, threads);
+	}
+
+	incremental_compiler_t::incremental_compiler_t()
+		: m_parser(std::make_unique<internal::parser_t>(""))
+	{ }
+
+	incremental_compiler_t::~incremental_compiler_t() = default;
+
+	auto incremental_compiler_t::compile(std::string_view expression_string) -> compile_result_t
+	{
+		m_text = expression_string;
+		m_tree = nullptr;
+		m_parser->reset(m_text);
+		return result(m_parser->parse());
+	}
+
+	auto incremental_compiler_t::edit(size_t offset, size_t removed, std::string_view inserted) -> compile_result_t
+	{
+		offset = std::min(offset, m_text.size());
+		removed = std::min(removed, m_text.size() - offset);
+		m_text.replace(offset, removed, inserted);
+
+		// The last tree goes back to the parser, copied only when a caller still holds on to it
+		if (m_tree)
+		{
+			if (m_tree.use_count() == 1)
+			{
+				m_parser->tree() = std::move(*m_tree);
+			}
+			else
+			{
+				m_parser->tree() = *m_tree;
+			}
+			m_tree = nullptr;
+		}
+
+		// Replaced subtrees stay in the tree until it is rebuilt, which bounds the garbage to a multiple of the live nodes
+		if (m_parser->tree().size() > internal::constants::reparse_garbage * (m_text.size() + 64))
+		{
+			m_parser->reset(m_text);
+		}
+		else
+		{
+			m_parser->edit(m_text, offset, removed, inserted.size());
+		}
+		return result(m_parser->parse());
+	}
+
+	auto incremental_compiler_t::text() const -> const std::string&
+	{
+		return m_text;
+	}
+
+	auto incremental_compiler_t::result(bool parsed) -> compile_result_t
+	{
+		compile_result_t result;
+		if (!parsed)
+		{
+			result.error = internal::parse_error(*m_parser);
+			return result;
+		}
+		m_tree = std::make_shared<internal::ast::tree_t>(std::move(m_parser->tree()));
+		result.tree = m_tree;
+		return result;
+	}
+
+}
\ No newline at end of file
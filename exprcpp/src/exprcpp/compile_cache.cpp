@@ -0,0 +1,179 @@
+#include "exprcpp/compile_cache.hpp"
+
+#include <algorithm>
+#include <functional>
+
+namespace exprcpp
+{
+
+	namespace internal
+	{
+
+		inline auto is_blank(char c) -> bool
+		{
+			return c == ' ' || c == '\t' || c == '\r' || c == '\f';
+		}
+
+	}
+
+	compile_cache_t::compile_cache_t(size_t capacity, size_t shards)
+		: m_capacity(std::max<size_t>(capacity, 1)), m_hits(0), m_misses(0), m_evictions(0)
+	{
+		shards = std::clamp<size_t>(shards, 1, m_capacity);
+		m_shard_capacity = (m_capacity + shards - 1) / shards;
+		for (size_t n = 0; n < shards; n++)
+		{
+			m_shards.push_back(std::make_unique<shard_t>());
+		}
+	}
+
+	auto compile_cache_t::find(std::string_view expression_string, const void* symbol_table) -> tree_ptr_t
+	{
+		std::string buffer;
+		const auto key = make_key(normalized(expression_string, buffer), symbol_table);
+
+		auto& cache = shard(key.hash);
+		std::lock_guard lock(cache.mutex);
+		auto it = cache.index.find(key);
+		if (it == cache.index.end())
+		{
+			m_misses.fetch_add(1, std::memory_order_relaxed);
+			return nullptr;
+		}
+
+		cache.entries.splice(cache.entries.begin(), cache.entries, it->second);
+		m_hits.fetch_add(1, std::memory_order_relaxed);
+		return it->second->tree;
+	}
+
+	auto compile_cache_t::insert(std::string_view expression_string, tree_ptr_t tree, const void* symbol_table) -> void
+	{
+		if (!tree)
+		{
+			return;
+		}
+
+		std::string buffer;
+		const auto key = make_key(normalized(expression_string, buffer), symbol_table);
+
+		auto& cache = shard(key.hash);
+		std::lock_guard lock(cache.mutex);
+
+		auto it = cache.index.find(key);
+		if (it != cache.index.end())
+		{
+			it->second->tree = std::move(tree);
+			cache.entries.splice(cache.entries.begin(), cache.entries, it->second);
+			return;
+		}
+
+		if (cache.entries.size() >= m_shard_capacity)
+		{
+			const auto& last = cache.entries.back();
+			cache.index.erase(make_key(last.text, last.symbol_table));
+			cache.entries.pop_back();
+			m_evictions.fetch_add(1, std::memory_order_relaxed);
+		}
+
+		auto& entry = cache.entries.emplace_front();
+		entry.text = key.text;
+		entry.symbol_table = symbol_table;
+		entry.tree = std::move(tree);
+		cache.index.emplace(key_t{ entry.text, symbol_table, key.hash }, cache.entries.begin());
+	}
+
+	auto compile_cache_t::clear() -> void
+	{
+		for (auto& cache : m_shards)
+		{
+			std::lock_guard lock(cache->mutex);
+			cache->index.clear();
+			cache->entries.clear();
+		}
+	}
+
+	auto compile_cache_t::capacity() const -> size_t
+	{
+		return m_capacity;
+	}
+
+	auto compile_cache_t::stats() const -> compile_cache_stats_t
+	{
+		compile_cache_stats_t stats;
+		stats.hits = m_hits.load(std::memory_order_relaxed);
+		stats.misses = m_misses.load(std::memory_order_relaxed);
+		stats.evictions = m_evictions.load(std::memory_order_relaxed);
+		for (const auto& cache : m_shards)
+		{
+			std::lock_guard lock(cache->mutex);
+			stats.size += cache->entries.size();
+		}
+		return stats;
+	}
+
+	auto compile_cache_t::normalize(std::string_view expression_string) -> std::string
+	{
+		std::string buffer;
+		return std::string(normalized(expression_string, buffer));
+	}
+
+	auto compile_cache_t::key_t::operator==(const key_t& other) const -> bool
+	{
+		return hash == other.hash && symbol_table == other.symbol_table && text == other.text;
+	}
+
+	auto compile_cache_t::key_hash_t::operator()(const key_t& key) const -> size_t
+	{
+		return key.hash;
+	}
+
+	auto compile_cache_t::make_key(std::string_view text, const void* symbol_table) -> key_t
+	{
+		key_t key;
+		key.text = text;
+		key.symbol_table = symbol_table;
+		key.hash = std::hash<std::string_view>()(text) ^ (std::hash<const void*>()(symbol_table) * 0x9E3779B97F4A7C15ull);
+		return key;
+	}
+
+	auto compile_cache_t::normalized(std::string_view expression_string, std::string& buffer) -> std::string_view
+	{
+		// Formulas are usually stored already tidy, then the text is used as is and nothing is copied
+		bool tidy = expression_string.empty() || (!internal::is_blank(expression_string.front()) && !internal::is_blank(expression_string.back()));
+		for (size_t i = 0; tidy && i < expression_string.size(); i++)
+		{
+			const char c = expression_string[i];
+			tidy = !internal::is_blank(c) || (c == ' ' && !internal::is_blank(expression_string[i + 1]));
+		}
+		if (tidy)
+		{
+			return expression_string;
+		}
+
+		buffer.clear();
+		buffer.reserve(expression_string.size());
+		bool blank = false;
+		for (const char c : expression_string)
+		{
+			if (internal::is_blank(c))
+			{
+				blank = true;
+				continue;
+			}
+			if (blank && !buffer.empty())
+			{
+				buffer.push_back(' ');
+			}
+			blank = false;
+			buffer.push_back(c);
+		}
+		return buffer;
+	}
+
+	auto compile_cache_t::shard(size_t hash) -> shard_t&
+	{
+		// The low bits pick the bucket inside the shard's map, so shards are chosen by the high bits
+		return *m_shards[(hash >> (sizeof(size_t) * 4)) % m_shards.size()];
+	}
+
+}
\ No newline at end of file
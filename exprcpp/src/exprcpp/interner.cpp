@@ -0,0 +1,284 @@
+#include "exprcpp/interner.hpp"
+
+#include <functional>
+#include <mutex>
+
+namespace exprcpp::internal
+{
+
+	interner_t::interner_t()
+		: m_size(0)
+	{
+		for (auto& chunk : m_chunks)
+		{
+			chunk.store(nullptr, std::memory_order_relaxed);
+		}
+		m_slots.assign(64, 0);
+	}
+
+	interner_t::~interner_t()
+	{
+		for (auto& chunk : m_chunks)
+		{
+			delete[] chunk.load(std::memory_order_relaxed);
+		}
+	}
+
+	auto interner_t::intern(std::string_view text) -> string_id_t
+	{
+		const size_t hash = std::hash<std::string_view>()(text);
+		{
+			std::shared_lock lock(m_mutex);
+			const auto id = lookup(text, hash);
+			if (id != invalid_string_id)
+			{
+				entry(id).references.fetch_add(1, std::memory_order_relaxed);
+				return id;
+			}
+		}
+
+		std::unique_lock lock(m_mutex);
+		auto id = lookup(text, hash);
+		if (id != invalid_string_id)
+		{
+			entry(id).references.fetch_add(1, std::memory_order_relaxed);
+			return id;
+		}
+
+		if (!m_free.empty())
+		{
+			id = m_free.back();
+			m_free.pop_back();
+		}
+		else
+		{
+			id = m_size.load(std::memory_order_relaxed);
+			if ((id >> chunk_bits) >= max_chunks)
+			{
+				return invalid_string_id;
+			}
+			if (m_chunks[id >> chunk_bits].load(std::memory_order_relaxed) == nullptr)
+			{
+				m_chunks[id >> chunk_bits].store(new entry_t[chunk_size], std::memory_order_release);
+			}
+			m_size.store(id + 1, std::memory_order_release);
+		}
+
+		auto& held = entry(id);
+		held.text = text;
+		held.references.store(1, std::memory_order_relaxed);
+		held.live = true;
+		m_live++;
+
+		// Keep the load factor at or below one half
+		if (m_live * 2 > m_slots.size())
+		{
+			rehash(m_slots.size() * 2);
+		}
+		else
+		{
+			insert(id, hash);
+		}
+		return id;
+	}
+
+	auto interner_t::find(std::string_view text) const -> string_id_t
+	{
+		std::shared_lock lock(m_mutex);
+		return lookup(text, std::hash<std::string_view>()(text));
+	}
+
+	auto interner_t::acquire(string_id_t id) -> void
+	{
+		if (id < m_size.load(std::memory_order_acquire))
+		{
+			entry(id).references.fetch_add(1, std::memory_order_relaxed);
+		}
+	}
+
+	auto interner_t::release(string_id_t id) -> void
+	{
+		if (id >= m_size.load(std::memory_order_acquire) || entry(id).references.fetch_sub(1, std::memory_order_acq_rel) != 1)
+		{
+			return;
+		}
+
+		// It may have been found and let go again before the lock was taken, only a string nobody holds is freed
+		std::unique_lock lock(m_mutex);
+		auto& held = entry(id);
+		if (!held.live || held.references.load(std::memory_order_relaxed) != 0)
+		{
+			return;
+		}
+		erase(id, std::hash<std::string_view>()(held.text));
+		held.text = std::string();
+		held.live = false;
+		m_free.push_back(id);
+		m_live--;
+	}
+
+	auto interner_t::get(string_id_t id) const -> const std::string&
+	{
+		static const std::string none;
+		if (id >= m_size.load(std::memory_order_acquire))
+		{
+			return none;
+		}
+		return entry(id).text;
+	}
+
+	auto interner_t::size() const -> size_t
+	{
+		std::shared_lock lock(m_mutex);
+		return m_live;
+	}
+
+	auto interner_t::entry(string_id_t id) const -> entry_t&
+	{
+		return m_chunks[id >> chunk_bits].load(std::memory_order_acquire)[id & (chunk_size - 1)];
+	}
+
+	auto interner_t::lookup(std::string_view text, size_t hash) const -> string_id_t
+	{
+		const size_t mask = m_slots.size() - 1;
+		for (size_t slot = hash & mask; m_slots[slot] != 0; slot = (slot + 1) & mask)
+		{
+			if (entry(m_slots[slot] - 1).text == text)
+			{
+				return m_slots[slot] - 1;
+			}
+		}
+		return invalid_string_id;
+	}
+
+	auto interner_t::insert(string_id_t id, size_t hash) -> void
+	{
+		const size_t mask = m_slots.size() - 1;
+		size_t slot = hash & mask;
+		while (m_slots[slot] != 0)
+		{
+			slot = (slot + 1) & mask;
+		}
+		m_slots[slot] = id + 1;
+	}
+
+	auto interner_t::erase(string_id_t id, size_t hash) -> void
+	{
+		const size_t mask = m_slots.size() - 1;
+		size_t hole = hash & mask;
+		while (m_slots[hole] != id + 1)
+		{
+			hole = (hole + 1) & mask;
+		}
+
+		// Later entries of the probe run move back into the hole unless that would put them before their home slot
+		for (size_t slot = (hole + 1) & mask; m_slots[slot] != 0; slot = (slot + 1) & mask)
+		{
+			const size_t home = std::hash<std::string_view>()(entry(m_slots[slot] - 1).text) & mask;
+			if (((slot - home) & mask) >= ((slot - hole) & mask))
+			{
+				m_slots[hole] = m_slots[slot];
+				hole = slot;
+			}
+		}
+		m_slots[hole] = 0;
+	}
+
+	auto interner_t::rehash(size_t slots) -> void
+	{
+		m_slots.assign(slots, 0);
+		const uint32_t size = m_size.load(std::memory_order_relaxed);
+		for (uint32_t id = 0; id < size; id++)
+		{
+			if (entry(id).live)
+			{
+				insert(id, std::hash<std::string_view>()(entry(id).text));
+			}
+		}
+	}
+
+	auto global_interner() -> interner_t&
+	{
+		// Never destroyed, so tables and batches that outlive static destruction order can still release their names
+		static interner_t* const interner = new interner_t();
+		return *interner;
+	}
+
+	string_refs_t::string_refs_t(const string_refs_t& other)
+		: m_ids(other.m_ids)
+	{
+		for (const auto id : m_ids)
+		{
+			global_interner().acquire(id);
+		}
+	}
+
+	string_refs_t::string_refs_t(string_refs_t&& other) noexcept
+		: m_ids(std::move(other.m_ids))
+	{
+		other.m_ids.clear();
+	}
+
+	string_refs_t::~string_refs_t()
+	{
+		clear();
+	}
+
+	auto string_refs_t::operator=(const string_refs_t& other) -> string_refs_t&
+	{
+		if (this != &other)
+		{
+			for (const auto id : other.m_ids)
+			{
+				global_interner().acquire(id);
+			}
+			clear();
+			m_ids = other.m_ids;
+		}
+		return *this;
+	}
+
+	auto string_refs_t::operator=(string_refs_t&& other) noexcept -> string_refs_t&
+	{
+		if (this != &other)
+		{
+			clear();
+			m_ids = std::move(other.m_ids);
+			other.m_ids.clear();
+		}
+		return *this;
+	}
+
+	auto string_refs_t::add(string_id_t id) -> void
+	{
+		if (id != invalid_string_id)
+		{
+			global_interner().acquire(id);
+			m_ids.push_back(id);
+		}
+	}
+
+	auto string_refs_t::clear() -> void
+	{
+		for (const auto id : m_ids)
+		{
+			global_interner().release(id);
+		}
+		m_ids.clear();
+	}
+
+	interned_t::interned_t(std::string_view text)
+		: m_id(global_interner().intern(text))
+	{ }
+
+	interned_t::~interned_t()
+	{
+		global_interner().release(m_id);
+	}
+
+	auto interned_t::id() const -> string_id_t
+	{
+		return m_id;
+	}
+
+}
\ No newline at end of file
@@ -1,32 +1,241 @@
 #include "exprcpp/parser.hpp"
 
+#include <algorithm>
+#include <cstdint>
+
 namespace exprcpp::internal
 {
 
 	namespace memo_type
 	{
-		const auto sum		   = int(1);
-		const auto term		   = int(2);
-		const auto factor	   = int(3);
-		const auto primary	   = int(4);
-		const auto disjunction = int(5);
-		const auto conjunction = int(6);
+		const auto sum		   = int(0);
+		const auto term		   = int(1);
+		const auto factor	   = int(2);
+		const auto primary	   = int(3);
+		const auto disjunction = int(4);
+		const auto conjunction = int(5);
+		const auto count	   = int(6);
+	}
+
+	namespace precedence
+	{
+		const auto none		  = int(0);
+		const auto comparison = int(1);
+		const auto sum		  = int(2);
+		const auto term		  = int(3);
 	}
 
-	parser_t::parser_t(const std::string& expression_string)
+	static auto binary_precedence(token_type_e type, token_type_e next) -> int
+	{
+		switch (type)
+		{
+		case TOK_EQUALEQUAL:
+		case TOK_NOTEQUAL:
+		case TOK_LESS:
+		case TOK_LESSEQUAL:
+		case TOK_GREATER:
+		case TOK_GREATEREQUAL:
+		case TOK_IN:
+			return precedence::comparison;
+		case TOK_NOT:
+			return next == TOK_IN ? precedence::comparison : precedence::none;
+		case TOK_ADD:
+		case TOK_MINUS:
+			return precedence::sum;
+		case TOK_STAR:
+		case TOK_FSLASH:
+			return precedence::term;
+		default:
+			return precedence::none;
+		}
+	}
+
+	static auto binary_node(ast::tree_t& tree, ast::expr_id_t left, token_type_e type, ast::expr_id_t right) -> ast::expr_id_t
+	{
+		switch (type)
+		{
+		case TOK_EQUALEQUAL: return tree.cmp_op(left, ast::cmp_op_type_e::eq, right);
+		case TOK_NOTEQUAL: return tree.cmp_op(left, ast::cmp_op_type_e::Not_eq, right);
+		case TOK_LESS: return tree.cmp_op(left, ast::cmp_op_type_e::lt, right);
+		case TOK_LESSEQUAL: return tree.cmp_op(left, ast::cmp_op_type_e::lt_eq, right);
+		case TOK_GREATER: return tree.cmp_op(left, ast::cmp_op_type_e::gt, right);
+		case TOK_GREATEREQUAL: return tree.cmp_op(left, ast::cmp_op_type_e::gt_eq, right);
+		case TOK_IN: return tree.cmp_op(left, ast::cmp_op_type_e::in, right);
+		case TOK_NOT: return tree.cmp_op(left, ast::cmp_op_type_e::not_in, right);
+		case TOK_ADD: return tree.bin_op(left, ast::operator_type_e::add, right);
+		case TOK_MINUS: return tree.bin_op(left, ast::operator_type_e::sub, right);
+		case TOK_STAR: return tree.bin_op(left, ast::operator_type_e::mult, right);
+		case TOK_FSLASH: return tree.bin_op(left, ast::operator_type_e::div, right);
+		default: return ast::null_id;
+		}
+	}
+
+	parser_t::parser_t(std::string_view expression_string)
 		: m_tokenizer(expression_string)
-	{ }
+	{
+		// Every token but the end marker covers at least one character
+		m_tokens.reserve(expression_string.size() + 1);
+		m_tree.reserve(expression_string.size() / 2);
+	}
+
+	auto parser_t::reset(std::string_view expression_string) -> void
+	{
+		m_tokenizer.reset(expression_string);
+		m_tokens.clear();
+		m_memos.clear();
+		m_list_stack.clear();
+		m_tree = ast::tree_t();
+		m_mark = 0;
+		m_reach = 0;
+		m_expected = TOK_UNKNOWN;
+
+		m_tokens.reserve(expression_string.size() + 1);
+		m_tree.reserve(expression_string.size() / 2);
+	}
+
+	auto parser_t::compile(ast::tree_t& tree) -> bool
+	{
+		if (!parse())
+		{
+			return false;
+		}
+		tree = std::move(m_tree);
+		return true;
+	}
 
-	auto parser_t::compile() -> ast::stmt_seq_ptr_t
+	auto parser_t::parse() -> bool
 	{
 		return rule_statements();
 	}
 
+	auto parser_t::tree() -> ast::tree_t&
+	{
+		return m_tree;
+	}
+
+	auto parser_t::edit(std::string_view expression_string, size_t offset, size_t removed, size_t inserted) -> void
+	{
+		// An error token keeps its message in the tokenizer, which a partial relex would lose
+		if (m_tokens.empty() || m_tokenizer.error() != nullptr)
+		{
+			reset(expression_string);
+			return;
+		}
+		const bool complete = m_tokens.back().type == TOK_ENDMARKER;
+
+		// Relex from one token before the first token touching the edit, a token may depend on the character after it
+		size_t first = std::partition_point(m_tokens.begin(), m_tokens.end(), [offset](const token_t& token) { return token.offset + token.length < offset; }) - m_tokens.begin();
+		first = std::min(first, m_tokens.size() - 1);
+		first = first > 0 ? first - 1 : 0;
+
+		m_tokenizer.reset(expression_string);
+		m_tokenizer.seek(first > 0 ? m_tokens[first].offset : 0);
+
+		// Once a fresh token starts where an old token behind the edit now sits, the rest of the stream is unchanged
+		const int64_t shift = static_cast<int64_t>(inserted) - static_cast<int64_t>(removed);
+		std::vector<token_t> fresh;
+		size_t old_next = first;
+		size_t resync = m_tokens.size();
+		while (true)
+		{
+			const auto token = m_tokenizer.get();
+			if (complete)
+			{
+				while (old_next < m_tokens.size() && (m_tokens[old_next].offset < offset + removed || m_tokens[old_next].offset + shift < token.offset))
+				{
+					old_next++;
+				}
+				if (old_next < m_tokens.size() && m_tokens[old_next].offset + shift == token.offset)
+				{
+					resync = old_next;
+					break;
+				}
+			}
+			fresh.push_back(token);
+			if (token.type == TOK_ENDMARKER || token.type == TOK_ERRORTOKEN)
+			{
+				break;
+			}
+		}
+
+		// Tokens ending before the edit kept their text, the first one that differs or reaches the edit is changed
+		size_t changed = first;
+		while (changed - first < fresh.size() && changed < resync)
+		{
+			const auto& token = fresh[changed - first];
+			const auto& old_token = m_tokens[changed];
+			if (token.offset + token.length >= offset || token.type != old_token.type || token.offset != old_token.offset || token.length != old_token.length)
+			{
+				break;
+			}
+			changed++;
+		}
+
+		const auto count = static_cast<size_t>(memo_type::count);
+		const bool spliced = resync < m_tokens.size();
+		const int64_t index_shift = static_cast<int64_t>(first + fresh.size()) - static_cast<int64_t>(resync);
+		m_tokens.erase(m_tokens.begin() + first, m_tokens.begin() + resync);
+		m_tokens.insert(m_tokens.begin() + first, fresh.begin(), fresh.end());
+		for (size_t n = first + fresh.size(); n < m_tokens.size(); n++)
+		{
+			m_tokens[n].offset = static_cast<uint32_t>(m_tokens[n].offset + shift);
+		}
+		if (spliced)
+		{
+			m_tokenizer.seek(expression_string.size());
+		}
+
+		// Entries before the edit survive if they never looked at a changed token, entries behind it move with their tokens
+		m_memos.resize(std::max(m_memos.size(), resync * count));
+		m_memos.erase(m_memos.begin() + first * count, m_memos.begin() + resync * count);
+		m_memos.insert(m_memos.begin() + first * count, fresh.size() * count, memo_t());
+		for (size_t n = 0; n < first * count; n++)
+		{
+			if (m_memos[n].reach >= changed)
+			{
+				m_memos[n] = memo_t();
+			}
+		}
+		for (size_t n = (first + fresh.size()) * count; index_shift != 0 && n < m_memos.size(); n++)
+		{
+			if (m_memos[n].mark >= 0)
+			{
+				m_memos[n].mark = static_cast<int>(m_memos[n].mark + index_shift);
+				m_memos[n].reach = static_cast<uint32_t>(m_memos[n].reach + index_shift);
+			}
+		}
+
+		m_list_stack.clear();
+		m_mark = 0;
+		m_reach = 0;
+		m_expected = TOK_UNKNOWN;
+	}
+
+	auto parser_t::failure() const -> parse_failure_t
+	{
+		parse_failure_t failure;
+		if (m_tokens.empty())
+		{
+			return failure;
+		}
+		failure.token = m_tokens[std::min(m_reach, m_tokens.size() - 1)];
+		if (m_expected_mark == m_reach)
+		{
+			failure.expected = m_expected;
+		}
+		if (failure.token.type == TOK_ERRORTOKEN)
+		{
+			failure.message = m_tokenizer.error();
+		}
+		return failure;
+	}
+
 	auto parser_t::fill_token() -> token_type_e
 	{
 		auto token = m_tokenizer.get();
 		m_tokens.push_back(token);
-		return token->type;
+		m_memos.resize(m_tokens.size() * memo_type::count);
+		return token.type;
 	}
 
 	auto parser_t::expect_token(token_type_e type) -> bool
@@ -39,8 +248,8 @@ namespace exprcpp::internal
 			}
 		}
 
-		auto token = m_tokens[m_mark];
-		if (token->type != type)
+		m_reach = std::max(m_reach, m_mark);
+		if (m_tokens[m_mark].type != type)
 		{
 			return false;
 		}
@@ -48,7 +257,7 @@ namespace exprcpp::internal
 		return true;
 	}
 
-	auto parser_t::expect_token(token_type_e type, token_ptr_t& token) -> bool
+	auto parser_t::expect_token(token_type_e type, token_t& token) -> bool
 	{
 		if (m_mark == m_tokens.size())
 		{
@@ -58,8 +267,9 @@ namespace exprcpp::internal
 			}
 		}
 
+		m_reach = std::max(m_reach, m_mark);
 		token = m_tokens[m_mark];
-		if (token->type != type)
+		if (token.type != type)
 		{
 			return false;
 		}
@@ -67,67 +277,109 @@ namespace exprcpp::internal
 		return true;
 	}
 
-	auto parser_t::is_memoized(int type, ast::node_ptr_t& pres) -> bool
+	auto parser_t::require_token(token_type_e type) -> bool
 	{
-		if (m_mark == m_tokens.size())
+		if (expect_token(type))
 		{
-			if (fill_token() < 0)
-			{
-				return false;
-			}
+			return true;
 		}
 
-		auto token = m_tokens[m_mark];
+		record_expected(type, m_mark);
+		return false;
+	}
 
-		for (auto memo = token->memo; memo != nullptr; memo = memo->next)
+	auto parser_t::record_expected(token_type_e type, size_t mark) -> void
+	{
+		// Only failures are recorded, the first rule to give up at the furthest token names what was missing
+		if (type != TOK_UNKNOWN && (m_expected == TOK_UNKNOWN || mark > m_expected_mark))
 		{
-			if (memo->type == type)
-			{
-				m_mark = memo->mark;
-				pres = memo->node;
-				return true;
-			}
+			m_expected = type;
+			m_expected_mark = mark;
 		}
-		return false;
 	}
 
-	auto parser_t::insert_memo(size_t mark, int type, ast::node_ptr_t node) -> bool
+	auto parser_t::peek_token(size_t ahead) -> token_type_e
 	{
-		auto memo = std::make_shared<memo_t>();
-		if (memo == nullptr)
+		while (m_mark + ahead >= m_tokens.size())
 		{
-			return false;
+			fill_token();
 		}
-		memo->type = type;
-		memo->node = node;
-		memo->mark = m_mark;
-		memo->next = m_tokens[mark]->memo;
-		m_tokens[mark]->memo = memo;
-		return true;
+		m_reach = std::max(m_reach, m_mark + ahead);
+		return m_tokens[m_mark + ahead].type;
+	}
+
+	auto parser_t::token_text(const token_t& token) const -> std::string_view
+	{
+		return m_tokenizer.text(token);
 	}
 
-	auto parser_t::update_memo(size_t mark, int type, ast::node_ptr_t node) -> bool
+	auto parser_t::list_from(size_t base) -> ast::range_t
 	{
-		for (auto memo = m_tokens[mark]->memo; memo != nullptr; memo = memo->next)
+		auto range = m_tree.list(m_list_stack.data() + base, m_list_stack.size() - base);
+		m_list_stack.resize(base);
+		return range;
+	}
+
+	auto parser_t::is_memoized(int type, ast::expr_id_t& pres) -> bool
+	{
+		if (m_mark == m_tokens.size())
 		{
-			if (memo->type == type)
+			if (fill_token() < 0)
 			{
-				memo->node = node;
-				memo->mark = m_mark;
-				return true;
+				return false;
 			}
 		}
-		return insert_memo(mark, type, node);
+
+		const auto& memo = m_memos[m_mark * memo_type::count + type];
+		if (memo.mark < 0)
+		{
+			return false;
+		}
+		// Replays what the rule looked at, as running it again would, so a reused entry fails the parse at the same place
+		m_mark = memo.mark;
+		m_reach = std::max<size_t>(m_reach, memo.reach);
+		record_expected(memo.expected, memo.reach);
+		pres = memo.node;
+		return true;
+	}
+
+	auto parser_t::store_memo(size_t mark, int type, ast::expr_id_t node) -> bool
+	{
+		auto& memo = m_memos[mark * memo_type::count + type];
+		memo.node = std::move(node);
+		memo.mark = static_cast<int>(m_mark);
+		memo.reach = static_cast<uint32_t>(m_reach);
+		memo.expected = m_expected_mark == m_reach ? m_expected : TOK_UNKNOWN;
+		return true;
 	}
 
-	auto parser_t::rule_statements() -> ast::stmt_seq_ptr_t
+	parser_t::rule_scope_t::rule_scope_t(parser_t& parser)
+		: parser(parser)
+		, reach(parser.m_reach)
+		, expected_mark(parser.m_expected_mark)
+		, expected(parser.m_expected)
+	{
+		parser.m_reach = 0;
+		parser.m_expected = TOK_UNKNOWN;
+	}
+
+	parser_t::rule_scope_t::~rule_scope_t()
+	{
+		const auto own_mark = parser.m_expected_mark;
+		const auto own = parser.m_expected;
+		parser.m_reach = std::max(parser.m_reach, reach);
+		parser.m_expected = expected;
+		parser.m_expected_mark = expected_mark;
+		parser.record_expected(own, own_mark);
+	}
+
+	auto parser_t::rule_statements() -> bool
 	{
 		auto mark = m_mark;
-		auto start_mark = m_mark;
-		std::vector<ast::stmt_ptr_t> elements;
+		std::vector<ast::stmt_id_t> elements;
 
 		{ // statement+
-			ast::stmt_ptr_t statement;
+			ast::stmt_id_t statement = ast::null_id;
 			while (
 				(statement = rule_statement())
 				)
@@ -140,19 +392,18 @@ namespace exprcpp::internal
 
 		if (elements.empty())
 		{
-			return nullptr;
+			return false;
 		}
 
-		auto statements = std::make_shared<ast::stmt_seq_t>();
-		statements->elements = elements;
-		return statements;
+		m_tree.set_statements(std::move(elements));
+		return true;
 	}
 
-	auto parser_t::rule_statement() -> ast::stmt_ptr_t
+	auto parser_t::rule_statement() -> ast::stmt_id_t
 	{
 		auto mark = m_mark;
 		{ // expression NEWLINE
-			ast::stmt_ptr_t stmt;
+			ast::stmt_id_t stmt = ast::null_id;
 			if (
 				(stmt = rule_simple_statement()) &&
 				expect_token(TOK_NEWLINE)
@@ -163,7 +414,7 @@ namespace exprcpp::internal
 		}
 		m_mark = mark;
 		{ // simple_statement ENDMARKER
-			ast::stmt_ptr_t stmt;
+			ast::stmt_id_t stmt = ast::null_id;
 			if (
 				(stmt = rule_simple_statement()) &&
 				expect_token(TOK_ENDMARKER)
@@ -174,14 +425,14 @@ namespace exprcpp::internal
 		}
 
 		m_mark = mark;
-		return nullptr;
+		return ast::null_id;
 	}
 
-	auto parser_t::rule_simple_statement() -> ast::stmt_ptr_t
+	auto parser_t::rule_simple_statement() -> ast::stmt_id_t
 	{
 		auto mark = m_mark;
 		{ // if_else
-			ast::stmt_ptr_t if_else;
+			ast::stmt_id_t if_else = ast::null_id;
 			if (
 				(if_else = rule_if_else())
 				)
@@ -191,26 +442,26 @@ namespace exprcpp::internal
 		}
 		m_mark = mark;
 		{ // expression
-			ast::expr_ptr_t expr;
+			ast::expr_id_t expr = ast::null_id;
 			if (
 				(expr = rule_expression())
 				)
 			{
-				return ast::expression(expr);
+				return m_tree.expression(expr);
 			}
 		}
 
 		m_mark = mark;
-		return nullptr;
+		return ast::null_id;
 	}
 
-	auto parser_t::rule_if_else() -> ast::stmt_ptr_t
+	auto parser_t::rule_if_else() -> ast::stmt_id_t
 	{
 		auto mark = m_mark;
 		{ // expression 'if' expression 'else' expression
-			ast::expr_ptr_t true_case;
-			ast::expr_ptr_t condition;
-			ast::expr_ptr_t false_case;
+			ast::expr_id_t true_case = ast::null_id;
+			ast::expr_id_t condition = ast::null_id;
+			ast::expr_id_t false_case = ast::null_id;
 			if (
 				(true_case = rule_expression()) &&
 				expect_token(TOK_IF) &&
@@ -219,32 +470,31 @@ namespace exprcpp::internal
 				(false_case = rule_expression())
 				)
 			{
-				return ast::if_else(condition, true_case, false_case);
+				return m_tree.if_else(condition, true_case, false_case);
 			}
 		}
 		m_mark = mark;
 		{ // expression 'if' expression
-			ast::expr_ptr_t true_case;
-			ast::expr_ptr_t condition;
-			ast::expr_ptr_t false_case;
+			ast::expr_id_t true_case = ast::null_id;
+			ast::expr_id_t condition = ast::null_id;
 			if (
 				(true_case = rule_expression()) &&
 				expect_token(TOK_IF) &&
 				(condition = rule_expression())
 				)
 			{
-				return ast::if_else(condition, true_case, nullptr);
+				return m_tree.if_else(condition, true_case, ast::null_id);
 			}
 		}
 		m_mark = mark;
-		return nullptr;
+		return ast::null_id;
 	}
 
-	auto parser_t::rule_expression() -> ast::expr_ptr_t
+	auto parser_t::rule_expression() -> ast::expr_id_t
 	{
 		auto mark = m_mark;
 		{ // assignment
-			ast::expr_ptr_t assign;
+			ast::expr_id_t assign = ast::null_id;
 			if (
 				(assign = rule_assignment())
 				)
@@ -254,7 +504,7 @@ namespace exprcpp::internal
 		}
 		m_mark = mark;
 		{ // disjunction
-			ast::expr_ptr_t disjunction;
+			ast::expr_id_t disjunction = ast::null_id;
 			if (
 				(disjunction = rule_disjunction())
 				)
@@ -264,53 +514,65 @@ namespace exprcpp::internal
 		}
 
 		m_mark = mark;
-		return nullptr;
+		return ast::null_id;
 	}
 
-	auto parser_t::rule_assignment() -> ast::expr_ptr_t
+	auto parser_t::rule_assignment() -> ast::expr_id_t
 	{
 		auto mark = m_mark;
 		{ // NAME ':=' expression
-			token_ptr_t name;
-			ast::expr_ptr_t value;
+			token_t name;
+			ast::expr_id_t value = ast::null_id;
 			if (
 				expect_token(TOK_NAME, name) &&
 				expect_token(TOK_COLONEQUAL) &&
 				(value = rule_expression())
 				)
 			{
-				return ast::assign(name->value, value);
+				return m_tree.assign(token_text(name), value);
 			}
 		}
 		m_mark = mark;
-		return nullptr;
+		return ast::null_id;
 	}
 
-	auto parser_t::rule_disjunction() -> ast::expr_ptr_t
+	auto parser_t::rule_disjunction() -> ast::expr_id_t
 	{
-		ast::node_ptr_t result;
+		ast::expr_id_t result = ast::null_id;
 		if (is_memoized(memo_type::disjunction, result))
 		{
-			return std::static_pointer_cast<ast::expression_t>(result);
+			return result;
 		}
+		const rule_scope_t scope(*this);
 
 		auto mark = m_mark;
+		{ // Single pass over well formed input, the rules below only run when it gives up
+			const auto base = m_list_stack.size();
+			if (
+				(result = fast_disjunction())
+				)
+			{
+				goto done;
+			}
+			m_list_stack.resize(base);
+		}
+		m_mark = mark;
 		{ // conjunction ('or' conjunction)+
-			ast::expr_ptr_t conjunction;
-			ast::expr_seq_ptr_t exprs;
+			ast::expr_id_t conjunction = ast::null_id;
+			ast::expr_seq_t exprs;
 			if (
 				(conjunction = rule_conjunction()) &&
-				(exprs = rule_or_conjunction())
+				rule_or_conjunction(exprs)
 				)
 			{
-				exprs->elements.insert(exprs->elements.begin(), conjunction);
-				result = ast::bool_op(ast::bool_op_type_e::Or, exprs);
+				exprs.insert(exprs.begin(), conjunction);
+				result = m_tree.bool_op(ast::bool_op_type_e::Or, m_tree.list(exprs.data(), exprs.size()));
 				goto done;
 			}
 		}
 		m_mark = mark;
 		{ // conjunction
-			ast::expr_ptr_t conjunction;
+			ast::expr_id_t conjunction = ast::null_id;
 			if (
 				(conjunction = rule_conjunction())
 				)
@@ -320,37 +582,38 @@ namespace exprcpp::internal
 			}
 		}
 		m_mark = mark;
-		return nullptr;
+		return ast::null_id;
 	done:
-		insert_memo(mark, memo_type::conjunction, result);
-		return std::static_pointer_cast<ast::expression_t>(result);
+		store_memo(mark, memo_type::disjunction, result);
+		return result;
 	}
 
-	auto parser_t::rule_conjunction() -> ast::expr_ptr_t
+	auto parser_t::rule_conjunction() -> ast::expr_id_t
 	{
-		ast::node_ptr_t result;
+		ast::expr_id_t result = ast::null_id;
 		if (is_memoized(memo_type::conjunction, result))
 		{
-			return std::static_pointer_cast<ast::expression_t>(result);
+			return result;
 		}
+		const rule_scope_t scope(*this);
 
 		auto mark = m_mark;
 		{ // inversion ('and' inversion)+
-			ast::expr_ptr_t inversion;
-			ast::expr_seq_ptr_t exprs;
+			ast::expr_id_t inversion = ast::null_id;
+			ast::expr_seq_t exprs;
 			if (
 				(inversion = rule_inversion()) &&
-				(exprs = rule_and_inversion())
+				rule_and_inversion(exprs)
 				)
 			{
-				exprs->elements.insert(exprs->elements.begin(), inversion);
-				result = ast::bool_op(ast::bool_op_type_e::And, exprs);
+				exprs.insert(exprs.begin(), inversion);
+				result = m_tree.bool_op(ast::bool_op_type_e::And, m_tree.list(exprs.data(), exprs.size()));
 				goto done;
 			}
 		}
 		m_mark = mark;
 		{ // inversion
-			ast::expr_ptr_t inversion;
+			ast::expr_id_t inversion = ast::null_id;
 			if (
 				(inversion = rule_inversion())
 				)
@@ -360,28 +623,28 @@ namespace exprcpp::internal
 			}
 		}
 		m_mark = mark;
-		return nullptr;
+		return ast::null_id;
 	done:
-		insert_memo(mark, memo_type::conjunction, result);
-		return std::static_pointer_cast<ast::expression_t>(result);
+		store_memo(mark, memo_type::conjunction, result);
+		return result;
 	}
 
-	auto parser_t::rule_inversion() -> ast::expr_ptr_t
+	auto parser_t::rule_inversion() -> ast::expr_id_t
 	{
 		auto mark = m_mark;
 		{ // 'not' comparison
-			ast::expr_ptr_t right;
+			ast::expr_id_t right = ast::null_id;
 			if (
 				expect_token(TOK_NOT) &&
 				(right = rule_comparison())
 				)
 			{
-				return ast::unary_op(ast::unary_op_type_e::Not, right);
+				return m_tree.unary_op(ast::unary_op_type_e::Not, right);
 			}
 		}
 		m_mark = mark;
 		{ // comparison
-			ast::expr_ptr_t comparison;
+			ast::expr_id_t comparison = ast::null_id;
 			if (
 				(comparison = rule_comparison())
 				)
@@ -390,106 +653,106 @@ namespace exprcpp::internal
 			}
 		}
 		m_mark = mark;
-		return nullptr;
+		return ast::null_id;
 	}
 
-	auto parser_t::rule_comparison() -> ast::expr_ptr_t
+	auto parser_t::rule_comparison() -> ast::expr_id_t
 	{
 		auto mark = m_mark;
 		{ // sum '==' comparison
-			ast::expr_ptr_t left;
-			ast::expr_ptr_t right;
+			ast::expr_id_t left = ast::null_id;
+			ast::expr_id_t right = ast::null_id;
 			if (
 				(left = rule_sum()) &&
 				expect_token(TOK_EQUALEQUAL) &&
 				(right = rule_comparison())
 				)
 			{
-				return ast::cmp_op(left, ast::cmp_op_type_e::eq, right);
+				return m_tree.cmp_op(left, ast::cmp_op_type_e::eq, right);
 			}
 		}
 		m_mark = mark;
 		{ // sum '!=' comparison
-			ast::expr_ptr_t left;
-			ast::expr_ptr_t right;
+			ast::expr_id_t left = ast::null_id;
+			ast::expr_id_t right = ast::null_id;
 			if (
 				(left = rule_sum()) &&
 				expect_token(TOK_NOTEQUAL) &&
 				(right = rule_comparison())
 				)
 			{
-				return ast::cmp_op(left, ast::cmp_op_type_e::Not_eq, right);
+				return m_tree.cmp_op(left, ast::cmp_op_type_e::Not_eq, right);
 			}
 		}
 		m_mark = mark;
 		{ // sum '<' comparison
-			ast::expr_ptr_t left;
-			ast::expr_ptr_t right;
+			ast::expr_id_t left = ast::null_id;
+			ast::expr_id_t right = ast::null_id;
 			if (
 				(left = rule_sum()) &&
 				expect_token(TOK_LESS) &&
 				(right = rule_comparison())
 				)
 			{
-				return ast::cmp_op(left, ast::cmp_op_type_e::lt, right);
+				return m_tree.cmp_op(left, ast::cmp_op_type_e::lt, right);
 			}
 		}
 		m_mark = mark;
 		{ // sum '<=' comparison
-			ast::expr_ptr_t left;
-			ast::expr_ptr_t right;
+			ast::expr_id_t left = ast::null_id;
+			ast::expr_id_t right = ast::null_id;
 			if (
 				(left = rule_sum()) &&
 				expect_token(TOK_LESSEQUAL) &&
 				(right = rule_comparison())
 				)
 			{
-				return ast::cmp_op(left, ast::cmp_op_type_e::lt_eq, right);
+				return m_tree.cmp_op(left, ast::cmp_op_type_e::lt_eq, right);
 			}
 		}
 		m_mark = mark;
 		{ // sum '>' comparison
-			ast::expr_ptr_t left;
-			ast::expr_ptr_t right;
+			ast::expr_id_t left = ast::null_id;
+			ast::expr_id_t right = ast::null_id;
 			if (
 				(left = rule_sum()) &&
 				expect_token(TOK_GREATER) &&
 				(right = rule_comparison())
 				)
 			{
-				return ast::cmp_op(left, ast::cmp_op_type_e::gt, right);
+				return m_tree.cmp_op(left, ast::cmp_op_type_e::gt, right);
 			}
 		}
 		m_mark = mark;
 		{ // sum '>=' comparison
-			ast::expr_ptr_t left;
-			ast::expr_ptr_t right;
+			ast::expr_id_t left = ast::null_id;
+			ast::expr_id_t right = ast::null_id;
 			if (
 				(left = rule_sum()) &&
 				expect_token(TOK_GREATEREQUAL) &&
 				(right = rule_comparison())
 				)
 			{
-				return ast::cmp_op(left, ast::cmp_op_type_e::gt_eq, right);
+				return m_tree.cmp_op(left, ast::cmp_op_type_e::gt_eq, right);
 			}
 		}
 		m_mark = mark;
 		{ // sum 'in' comparison
-			ast::expr_ptr_t left;
-			ast::expr_ptr_t right;
+			ast::expr_id_t left = ast::null_id;
+			ast::expr_id_t right = ast::null_id;
 			if (
 				(left = rule_sum()) &&
 				expect_token(TOK_IN) &&
 				(right = rule_comparison())
 				)
 			{
-				return ast::cmp_op(left, ast::cmp_op_type_e::in, right);
+				return m_tree.cmp_op(left, ast::cmp_op_type_e::in, right);
 			}
 		}
 		m_mark = mark;
 		{ // sum 'not' 'in' comparison
-			ast::expr_ptr_t left;
-			ast::expr_ptr_t right;
+			ast::expr_id_t left = ast::null_id;
+			ast::expr_id_t right = ast::null_id;
 			if (
 				(left = rule_sum()) &&
 				expect_token(TOK_NOT) &&
@@ -497,12 +760,12 @@ namespace exprcpp::internal
 				(right = rule_comparison())
 				)
 			{
-				return ast::cmp_op(left, ast::cmp_op_type_e::not_in, right);
+				return m_tree.cmp_op(left, ast::cmp_op_type_e::not_in, right);
 			}
 		}
 		m_mark = mark;
 		{ // sum
-			ast::expr_ptr_t sum;
+			ast::expr_id_t sum = ast::null_id;
 			if (
 				(sum = rule_sum())
 				)
@@ -511,40 +774,40 @@ namespace exprcpp::internal
 			}
 		}
 		m_mark = mark;
-		return nullptr;
+		return ast::null_id;
 	}
 
-	auto parser_t::raw_sum() -> ast::expr_ptr_t
+	auto parser_t::raw_sum() -> ast::expr_id_t
 	{
 		auto mark = m_mark;
 		{ // sum '+' term
-			ast::expr_ptr_t left;
-			ast::expr_ptr_t right;
+			ast::expr_id_t left = ast::null_id;
+			ast::expr_id_t right = ast::null_id;
 			if (
 				(left = rule_sum()) &&
 				expect_token(TOK_ADD) &&
 				(right = rule_term())
 				)
 			{
-				return ast::bin_op(left, ast::operator_type_e::add, right);
+				return m_tree.bin_op(left, ast::operator_type_e::add, right);
 			}
 		}
 		m_mark = mark;
 		{ // sum '-' term
-			ast::expr_ptr_t left;
-			ast::expr_ptr_t right;
+			ast::expr_id_t left = ast::null_id;
+			ast::expr_id_t right = ast::null_id;
 			if (
 				(left = rule_sum()) &&
 				expect_token(TOK_MINUS) &&
 				(right = rule_term())
 				)
 			{
-				return ast::bin_op(left, ast::operator_type_e::sub, right);
+				return m_tree.bin_op(left, ast::operator_type_e::sub, right);
 			}
 		}
 		m_mark = mark;
 		{ // term
-			ast::expr_ptr_t term;
+			ast::expr_id_t term = ast::null_id;
 			if (
 				(term = rule_term())
 				)
@@ -553,27 +816,28 @@ namespace exprcpp::internal
 			}
 		}
 		m_mark = mark;
-		return nullptr;
+		return ast::null_id;
 	}
 
-	auto parser_t::rule_sum() -> ast::expr_ptr_t
+	auto parser_t::rule_sum() -> ast::expr_id_t
 	{
-		ast::node_ptr_t result = 0;
+		ast::expr_id_t result = ast::null_id;
 		if (is_memoized(memo_type::sum, result))
 		{
-			return std::static_pointer_cast<ast::expression_t>(result);result;
+			return result;
 		}
+		const rule_scope_t scope(*this);
 		auto mark = m_mark;
 		auto resmark = m_mark;
 		while (true)
 		{
-			if (!update_memo(mark, memo_type::sum, result))
+			if (!store_memo(mark, memo_type::sum, result))
 			{
-				return std::static_pointer_cast<ast::expression_t>(result);
+				return result;
 			}
 			m_mark = mark;
 			auto raw = raw_sum();
-			if (raw == nullptr || m_mark <= resmark)
+			if (raw == ast::null_id || m_mark <= resmark)
 			{
 				break;
 			}
@@ -581,40 +845,42 @@ namespace exprcpp::internal
 			result = raw;
 		}
 		m_mark = resmark;
-		return std::static_pointer_cast<ast::expression_t>(result);
+		// The pass that stopped the growth looked further than the entry stored before it
+		store_memo(mark, memo_type::sum, result);
+		return result;
 	}
 
-	auto parser_t::raw_term() -> ast::expr_ptr_t
+	auto parser_t::raw_term() -> ast::expr_id_t
 	{
 		auto mark = m_mark;
 		{ // term '*' factor
-			ast::expr_ptr_t left;
-			ast::expr_ptr_t right;
+			ast::expr_id_t left = ast::null_id;
+			ast::expr_id_t right = ast::null_id;
 			if (
 				(left = rule_term()) &&
 				expect_token(TOK_STAR) &&
 				(right = rule_factor())
 				)
 			{
-				return ast::bin_op(left, ast::operator_type_e::mult, right);
+				return m_tree.bin_op(left, ast::operator_type_e::mult, right);
 			}
 		}
 		m_mark = mark;
 		{ // term '/' factor
-			ast::expr_ptr_t left;
-			ast::expr_ptr_t right;
+			ast::expr_id_t left = ast::null_id;
+			ast::expr_id_t right = ast::null_id;
 			if (
 				(left = rule_term()) &&
 				expect_token(TOK_FSLASH) &&
 				(right = rule_factor())
 				)
 			{
-				return ast::bin_op(left, ast::operator_type_e::div, right);
+				return m_tree.bin_op(left, ast::operator_type_e::div, right);
 			}
 		}
 		m_mark = mark;
 		{ // factor
-			ast::expr_ptr_t factor;
+			ast::expr_id_t factor = ast::null_id;
 			if (
 				(factor = rule_factor())
 				)
@@ -623,27 +889,28 @@ namespace exprcpp::internal
 			}
 		}
 		m_mark = mark;
-		return nullptr;
+		return ast::null_id;
 	}
 
-	auto parser_t::rule_term() -> ast::expr_ptr_t
+	auto parser_t::rule_term() -> ast::expr_id_t
 	{
-		ast::node_ptr_t result = 0;
+		ast::expr_id_t result = ast::null_id;
 		if (is_memoized(memo_type::term, result))
 		{
-			return std::static_pointer_cast<ast::expression_t>(result);
+			return result;
 		}
+		const rule_scope_t scope(*this);
 		auto mark = m_mark;
 		auto resmark = m_mark;
 		while (true)
 		{
-			if (!update_memo(mark, memo_type::term, result))
+			if (!store_memo(mark, memo_type::term, result))
 			{
-				return std::static_pointer_cast<ast::expression_t>(result);
+				return result;
 			}
 			m_mark = mark;
 			auto raw = raw_term();
-			if (raw == nullptr || m_mark <= resmark)
+			if (raw == ast::null_id || m_mark <= resmark)
 			{
 				break;
 			}
@@ -651,56 +918,58 @@ namespace exprcpp::internal
 			result = raw;
 		}
 		m_mark = resmark;
-		return std::static_pointer_cast<ast::expression_t>(result);
+		store_memo(mark, memo_type::term, result);
+		return result;
 	}
 
-	auto parser_t::rule_factor() -> ast::expr_ptr_t
+	auto parser_t::rule_factor() -> ast::expr_id_t
 	{
-		ast::node_ptr_t result = 0;
+		ast::expr_id_t result = ast::null_id;
 		if (is_memoized(memo_type::factor, result))
 		{
-			return std::static_pointer_cast<ast::expression_t>(result);
+			return result;
 		}
+		const rule_scope_t scope(*this);
 
 		auto mark = m_mark;
 		{ // '+' factor
-			ast::expr_ptr_t right;
+			ast::expr_id_t right = ast::null_id;
 			if (
 				expect_token(TOK_ADD) &&
 				(right = rule_factor())
 				)
 			{
-				result = ast::unary_op(ast::unary_op_type_e::add, right);
+				result = m_tree.unary_op(ast::unary_op_type_e::add, right);
 				goto done;
 			}
 		}
 		m_mark = mark;
 		{ // '-' factor
-			ast::expr_ptr_t right;
+			ast::expr_id_t right = ast::null_id;
 			if (
 				expect_token(TOK_MINUS) &&
 				(right = rule_factor())
 				)
 			{
-				result = ast::unary_op(ast::unary_op_type_e::sub, right);
+				result = m_tree.unary_op(ast::unary_op_type_e::sub, right);
 				goto done;
 			}
 		}
 		m_mark = mark;
 		{ // '~' factor
-			ast::expr_ptr_t right;
+			ast::expr_id_t right = ast::null_id;
 			if (
 				expect_token(TOK_TILDE) &&
 				(right = rule_factor())
 				)
 			{
-				result = ast::unary_op(ast::unary_op_type_e::invert, right);
+				result = m_tree.unary_op(ast::unary_op_type_e::invert, right);
 				goto done;
 			}
 		}
 		m_mark = mark;
 		{ // power
-			ast::expr_ptr_t power;
+			ast::expr_id_t power = ast::null_id;
 			if (
 				(power = rule_power())
 				)
@@ -710,30 +979,30 @@ namespace exprcpp::internal
 			}
 		}
 		m_mark = mark;
-		return nullptr;
+		return ast::null_id;
 	done:
-		insert_memo(mark, memo_type::conjunction, result);
-		return std::static_pointer_cast<ast::expression_t>(result);
+		store_memo(mark, memo_type::factor, result);
+		return result;
 	}
 
-	auto parser_t::rule_power() -> ast::expr_ptr_t
+	auto parser_t::rule_power() -> ast::expr_id_t
 	{
 		auto mark = m_mark;
 		{ // primary '**' factor
-			ast::expr_ptr_t left;
-			ast::expr_ptr_t right;
+			ast::expr_id_t left = ast::null_id;
+			ast::expr_id_t right = ast::null_id;
 			if (
 				(left = rule_primary()) &&
 				expect_token(TOK_DOUBLESTAR) &&
 				(right = rule_factor())
 				)
 			{
-				return ast::bin_op(left, ast::operator_type_e::pow, right);
+				return m_tree.bin_op(left, ast::operator_type_e::pow, right);
 			}
 		}
 		m_mark = mark;
 		{ // primary
-			ast::expr_ptr_t primary;
+			ast::expr_id_t primary = ast::null_id;
 			if (
 				(primary = rule_primary())
 				)
@@ -742,28 +1011,28 @@ namespace exprcpp::internal
 			}
 		}
 		m_mark = mark;
-		return nullptr;
+		return ast::null_id;
 	}
 
-	auto parser_t::raw_primary() -> ast::expr_ptr_t
+	auto parser_t::raw_primary() -> ast::expr_id_t
 	{
 		auto mark = m_mark;
 		{ // NAME '(' arguments? ')'
-			token_ptr_t name;
-			ast::expr_seq_ptr_t args;
+			token_t name;
+			ast::expr_seq_t args;
 			if (
 				expect_token(TOK_NAME, name) &&
 				expect_token(TOK_LPAREN) &&
-				(args = rule_arguments(), 1) &&
-				expect_token(TOK_RPAREN)
+				(rule_arguments(args), 1) &&
+				require_token(TOK_RPAREN)
 				)
 			{
-				return ast::call(name->value, args);
+				return m_tree.call(token_text(name), m_tree.list(args.data(), args.size()));
 			}
 		}
 		m_mark = mark;
 		{ // slice
-			ast::expr_ptr_t slice;
+			ast::expr_id_t slice = ast::null_id;
 			if (
 				(slice = rule_slice())
 				)
@@ -773,7 +1042,7 @@ namespace exprcpp::internal
 		}
 		m_mark = mark;
 		{ // atom
-			ast::expr_ptr_t atom;
+			ast::expr_id_t atom = ast::null_id;
 			if (
 				(atom = rule_atom())
 				)
@@ -782,27 +1051,28 @@ namespace exprcpp::internal
 			}
 		}
 		m_mark = mark;
-		return nullptr;
+		return ast::null_id;
 	}
 
-	auto parser_t::rule_primary() -> ast::expr_ptr_t
+	auto parser_t::rule_primary() -> ast::expr_id_t
 	{
-		ast::node_ptr_t result = 0;
+		ast::expr_id_t result = ast::null_id;
 		if (is_memoized(memo_type::primary, result))
 		{
-			return std::static_pointer_cast<ast::expression_t>(result);
+			return result;
 		}
+		const rule_scope_t scope(*this);
 		auto mark = m_mark;
 		auto resmark = m_mark;
 		while (true)
 		{
-			if (!update_memo(mark, memo_type::primary, result))
+			if (!store_memo(mark, memo_type::primary, result))
 			{
-				return std::static_pointer_cast<ast::expression_t>(result);
+				return result;
 			}
 			m_mark = mark;
 			auto raw = raw_primary();
-			if (raw == nullptr || m_mark <= resmark)
+			if (raw == ast::null_id || m_mark <= resmark)
 			{
 				break;
 			}
@@ -810,34 +1080,35 @@ namespace exprcpp::internal
 			result = raw;
 		}
 		m_mark = resmark;
-		return std::static_pointer_cast<ast::expression_t>(result);
+		store_memo(mark, memo_type::primary, result);
+		return result;
 	}
 
-	auto parser_t::rule_atom() -> ast::expr_ptr_t
+	auto parser_t::rule_atom() -> ast::expr_id_t
 	{
 		auto mark = m_mark;
 		{ // NAME
-			token_ptr_t token;
+			token_t token;
 			if (
 				expect_token(TOK_NAME, token)
 				)
 			{
-				return ast::name(token->value, ast::expr_context_type_e::load);
+				return m_tree.name(token_text(token), ast::expr_context_type_e::load);
 			}
 		}
 		m_mark = mark;
 		{ // NUMBER
-			token_ptr_t token;
+			token_t token;
 			if (
 				expect_token(TOK_NUMBER, token)
 				)
 			{
-				return ast::constant(token->value);
+				return m_tree.constant(token_text(token));
 			}
 		}
 		m_mark = mark;
 		{ // vector
-			ast::expr_ptr_t vector;
+			ast::expr_id_t vector = ast::null_id;
 			if (
 				(vector = rule_vector())
 				)
@@ -847,28 +1118,26 @@ namespace exprcpp::internal
 		}
 		m_mark = mark;
 		{ // '(' expression ')'
-			ast::expr_ptr_t expr;
+			ast::expr_id_t expr = ast::null_id;
 			if (
 				expect_token(TOK_LPAREN) &&
 				(expr = rule_expression()) &&
-				expect_token(TOK_RPAREN)
+				require_token(TOK_RPAREN)
 				)
 			{
 				return expr;
 			}
 		}
 		m_mark = mark;
-		return nullptr;
+		return ast::null_id;
 	}
 
-	auto parser_t::rule_expression_commas() -> ast::expr_seq_ptr_t
+	auto parser_t::rule_expression_commas(ast::expr_seq_t& elements) -> bool
 	{
 		auto mark = m_mark;
-		auto start_mark = m_mark;
-		std::vector<ast::expr_ptr_t> elements;
 
 		{ // (expression ',')*
-			ast::expr_ptr_t expression;
+			ast::expr_id_t expression = ast::null_id;
 			while (
 				(expression = rule_expression()) &&
 				expect_token(TOK_COMMA)
@@ -880,59 +1149,55 @@ namespace exprcpp::internal
 			m_mark = mark;
 		}
 
-		auto expressions = std::make_shared<ast::expr_seq_t>();
-		expressions->elements = elements;
-		return expressions;
+		return true;
 	}
 
-	auto parser_t::rule_arguments() -> ast::expr_seq_ptr_t
+	auto parser_t::rule_arguments(ast::expr_seq_t& elements) -> bool
 	{
 		auto mark = m_mark;
 		{ // (expression ',')* expression
-			ast::expr_seq_ptr_t exprs;
-			ast::expr_ptr_t expr;
+			ast::expr_id_t expr = ast::null_id;
 			if (
-				(exprs = rule_expression_commas()) &&
+				rule_expression_commas(elements) &&
 				(expr = rule_expression())
 				)
 			{
-				exprs->elements.push_back(expr);
-				return exprs;
+				elements.push_back(expr);
+				return true;
 			}
 		}
 		m_mark = mark;
-		return nullptr;
+		elements.clear();
+		return false;
 	}
 
-	auto parser_t::rule_vector() -> ast::expr_ptr_t
+	auto parser_t::rule_vector() -> ast::expr_id_t
 	{
 		auto mark = m_mark;
 		{ // '[' (expression ',')* expression ']'
-			ast::expr_seq_ptr_t exprs;
-			ast::expr_ptr_t expr;
+			ast::expr_seq_t exprs;
+			ast::expr_id_t expr = ast::null_id;
 			if (
 				expect_token(TOK_LSQB) &&
-				(exprs = rule_expression_commas()) &&
+				rule_expression_commas(exprs) &&
 				(expr = rule_expression()) &&
-				expect_token(TOK_RSQB)
+				require_token(TOK_RSQB)
 				)
 			{
-				exprs->elements.push_back(expr);
-				return ast::vector(exprs);
+				exprs.push_back(expr);
+				return m_tree.vector(m_tree.list(exprs.data(), exprs.size()));
 			}
 		}
 		m_mark = mark;
-		return nullptr;
+		return ast::null_id;
 	}
 
-	auto parser_t::rule_or_conjunction() -> ast::expr_seq_ptr_t
+	auto parser_t::rule_or_conjunction(ast::expr_seq_t& elements) -> bool
 	{
 		auto mark = m_mark;
-		auto start_mark = m_mark;
-		std::vector<ast::expr_ptr_t> elements;
 
 		{ // ('or' conjunction)+
-			ast::expr_ptr_t conjunction;
+			ast::expr_id_t conjunction = ast::null_id;
 			while (
 				expect_token(TOK_OR) &&
 				(conjunction = rule_conjunction())
@@ -944,24 +1209,15 @@ namespace exprcpp::internal
 			m_mark = mark;
 		}
 
-		if (elements.empty())
-		{
-			return nullptr;
-		}
-
-		auto expressions = std::make_shared<ast::expr_seq_t>();
-		expressions->elements = elements;
-		return expressions;
+		return !elements.empty();
 	}
 
-	auto parser_t::rule_and_inversion() -> ast::expr_seq_ptr_t
+	auto parser_t::rule_and_inversion(ast::expr_seq_t& elements) -> bool
 	{
 		auto mark = m_mark;
-		auto start_mark = m_mark;
-		std::vector<ast::expr_ptr_t> elements;
 
 		{ // ('and' inversion)+
-			ast::expr_ptr_t inversion;
+			ast::expr_id_t inversion = ast::null_id;
 			while (
 				expect_token(TOK_AND) &&
 				(inversion = rule_inversion())
@@ -973,37 +1229,256 @@ namespace exprcpp::internal
 			m_mark = mark;
 		}
 
-		if (elements.empty())
-		{
-			return nullptr;
-		}
-
-		auto expressions = std::make_shared<ast::expr_seq_t>();
-		expressions->elements = elements;
-		return expressions;
+		return !elements.empty();
 	}
 
-	auto parser_t::rule_slice() -> ast::expr_ptr_t
+	auto parser_t::rule_slice() -> ast::expr_id_t
 	{
 		auto mark = m_mark;
 		{ // primary '[' sum? ':' sum? ']'
-			ast::expr_ptr_t vector;
-			ast::expr_ptr_t start;
-			ast::expr_ptr_t stop;
+			ast::expr_id_t vector = ast::null_id;
+			ast::expr_id_t start = ast::null_id;
+			ast::expr_id_t stop = ast::null_id;
 			if (
 				(vector = rule_primary()) &&
 				expect_token(TOK_LSQB) &&
 				(start = rule_sum(), 1) &&
-				expect_token(TOK_COLON) &&
+				require_token(TOK_COLON) &&
 				(stop = rule_sum(), 1) &&
-				expect_token(TOK_RSQB)
+				require_token(TOK_RSQB)
 				)
 			{
-				return ast::slice(vector, start, stop);
+				return m_tree.slice(vector, start, stop);
 			}
 		}
 		m_mark = mark;
-		return nullptr;
+		return ast::null_id;
+	}
+
+	auto parser_t::fast_expression() -> ast::expr_id_t
+	{
+		if (peek_token() == TOK_NAME && peek_token(1) == TOK_COLONEQUAL)
+		{ // NAME ':=' expression
+			auto name = token_text(m_tokens[m_mark]);
+			m_mark += 2;
+			auto value = fast_expression();
+			return value != ast::null_id ? m_tree.assign(name, value) : ast::null_id;
+		}
+		return fast_disjunction();
+	}
+
+	auto parser_t::fast_disjunction() -> ast::expr_id_t
+	{
+		// Shares the grammar rule's memo, a reparse after an edit picks up untouched subexpressions here
+		ast::expr_id_t result = ast::null_id;
+		if (is_memoized(memo_type::disjunction, result))
+		{
+			return result;
+		}
+		const rule_scope_t scope(*this);
+
+		const auto mark = m_mark;
+		auto conjunction = fast_conjunction();
+		if (conjunction == ast::null_id || peek_token() != TOK_OR)
+		{
+			result = conjunction;
+		}
+		else
+		{
+			const auto base = m_list_stack.size();
+			m_list_stack.push_back(conjunction);
+			while (expect_token(TOK_OR))
+			{
+				if (!(conjunction = fast_conjunction()))
+				{
+					return ast::null_id;
+				}
+				m_list_stack.push_back(conjunction);
+			}
+			result = m_tree.bool_op(ast::bool_op_type_e::Or, list_from(base));
+		}
+
+		if (result != ast::null_id)
+		{
+			store_memo(mark, memo_type::disjunction, result);
+		}
+		return result;
+	}
+
+	auto parser_t::fast_conjunction() -> ast::expr_id_t
+	{
+		auto inversion = fast_inversion();
+		if (inversion == ast::null_id || peek_token() != TOK_AND)
+		{
+			return inversion;
+		}
+
+		const auto base = m_list_stack.size();
+		m_list_stack.push_back(inversion);
+		while (expect_token(TOK_AND))
+		{
+			if (!(inversion = fast_inversion()))
+			{
+				return ast::null_id;
+			}
+			m_list_stack.push_back(inversion);
+		}
+		return m_tree.bool_op(ast::bool_op_type_e::And, list_from(base));
+	}
+
+	auto parser_t::fast_inversion() -> ast::expr_id_t
+	{
+		if (expect_token(TOK_NOT))
+		{ // 'not' comparison
+			auto right = fast_binary(precedence::comparison);
+			return right != ast::null_id ? m_tree.unary_op(ast::unary_op_type_e::Not, right) : ast::null_id;
+		}
+		return fast_binary(precedence::comparison);
+	}
+
+	auto parser_t::fast_binary(int min_precedence) -> ast::expr_id_t
+	{
+		auto left = fast_factor();
+		while (left != ast::null_id)
+		{
+			// Only 'not in' needs the token after the operator, peeking it otherwise would widen every memo's reach
+			const auto type = peek_token();
+			const auto op_precedence = binary_precedence(type, type == TOK_NOT ? peek_token(1) : TOK_UNKNOWN);
+			if (op_precedence == precedence::none || op_precedence < min_precedence)
+			{
+				break;
+			}
+			m_mark += type == TOK_NOT ? 2 : 1;
+
+			// Comparisons chain to the right like the grammar's 'sum op comparison', arithmetic is left associative
+			auto right = fast_binary(op_precedence == precedence::comparison ? op_precedence : op_precedence + 1);
+			if (right == ast::null_id)
+			{
+				return ast::null_id;
+			}
+			left = binary_node(m_tree, left, type, right);
+		}
+		return left;
+	}
+
+	auto parser_t::fast_factor() -> ast::expr_id_t
+	{
+		auto op = ast::unary_op_type_e::add;
+		switch (peek_token())
+		{
+		case TOK_ADD:
+			op = ast::unary_op_type_e::add;
+			break;
+		case TOK_MINUS:
+			op = ast::unary_op_type_e::sub;
+			break;
+		case TOK_TILDE:
+			op = ast::unary_op_type_e::invert;
+			break;
+		default:
+			return fast_power();
+		}
+		m_mark++;
+		auto right = fast_factor();
+		return right != ast::null_id ? m_tree.unary_op(op, right) : ast::null_id;
+	}
+
+	auto parser_t::fast_power() -> ast::expr_id_t
+	{
+		auto primary = fast_primary();
+		if (primary == ast::null_id || !expect_token(TOK_DOUBLESTAR))
+		{
+			return primary;
+		}
+		auto right = fast_factor();
+		return right != ast::null_id ? m_tree.bin_op(primary, ast::operator_type_e::pow, right) : ast::null_id;
+	}
+
+	auto parser_t::fast_primary() -> ast::expr_id_t
+	{
+		ast::expr_id_t primary = ast::null_id;
+		token_t token;
+		if (expect_token(TOK_NAME, token))
+		{
+			if (!expect_token(TOK_LPAREN))
+			{
+				primary = m_tree.name(token_text(token), ast::expr_context_type_e::load);
+			}
+			else
+			{ // NAME '(' arguments? ')', the grammar never slices a call
+				ast::range_t args;
+				if (peek_token() != TOK_RPAREN && !fast_expressions(args))
+				{
+					return ast::null_id;
+				}
+				return require_token(TOK_RPAREN) ? m_tree.call(token_text(token), args) : ast::null_id;
+			}
+		}
+		else if (expect_token(TOK_NUMBER, token))
+		{
+			primary = m_tree.constant(token_text(token));
+		}
+		else if (expect_token(TOK_LSQB))
+		{
+			ast::range_t elements;
+			if (!fast_expressions(elements) || !require_token(TOK_RSQB))
+			{
+				return ast::null_id;
+			}
+			primary = m_tree.vector(elements);
+		}
+		else if (expect_token(TOK_LPAREN))
+		{
+			primary = fast_expression();
+			if (primary == ast::null_id || !require_token(TOK_RPAREN))
+			{
+				return ast::null_id;
+			}
+		}
+		else
+		{
+			return ast::null_id;
+		}
+
+		while (expect_token(TOK_LSQB))
+		{ // primary '[' sum? ':' sum? ']'
+			ast::expr_id_t start = ast::null_id;
+			ast::expr_id_t stop = ast::null_id;
+			if (peek_token() != TOK_COLON && !(start = fast_binary(precedence::sum)))
+			{
+				return ast::null_id;
+			}
+			if (!require_token(TOK_COLON))
+			{
+				return ast::null_id;
+			}
+			if (peek_token() != TOK_RSQB && !(stop = fast_binary(precedence::sum)))
+			{
+				return ast::null_id;
+			}
+			if (!require_token(TOK_RSQB))
+			{
+				return ast::null_id;
+			}
+			primary = m_tree.slice(primary, start, stop);
+		}
+		return primary;
+	}
+
+	auto parser_t::fast_expressions(ast::range_t& range) -> bool
+	{
+		const auto base = m_list_stack.size();
+		do
+		{
+			auto expr = fast_expression();
+			if (expr == ast::null_id)
+			{
+				return false;
+			}
+			m_list_stack.push_back(expr);
+		} while (expect_token(TOK_COMMA));
+		range = list_from(base);
+		return true;
 	}
 
 }
\ No newline at end of file
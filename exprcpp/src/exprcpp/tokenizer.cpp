@@ -1,31 +1,61 @@
 #include "exprcpp/tokenizer.hpp"
 
-#include <unordered_map>
+#include <array>
+#include <cstdint>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define EXPRCPP_SSE2
+#endif
 
 namespace exprcpp::internal
 {
 
+	namespace char_class
+	{
+		const uint8_t whitespace = 1;
+		const uint8_t identifier_start = 2;
+		const uint8_t identifier = 4;
+		const uint8_t digit = 8;
+	}
+
 	namespace constants
 	{
 
-		const std::unordered_map<std::string, token_type_e> keyword_token_pairs =
+		// One entry per byte value. Bytes above 127 stay unclassified, as they always were where char is signed
+		constexpr auto make_char_classes() -> std::array<uint8_t, 256>
 		{
-			{ "in", TOK_IN },
-			{ "not", TOK_NOT },
-			{ "if", TOK_IF },
-			{ "else", TOK_ELSE },
-			{ "and", TOK_AND },
-			{ "or", TOK_OR }
-		};
+			std::array<uint8_t, 256> classes = {};
+			for (const char c : { ' ', '\n', '\r', '\t', '\b', '\v', '\f' })
+			{
+				classes[static_cast<uint8_t>(c)] = char_class::whitespace;
+			}
+			for (int c = 0; c < 128; c++)
+			{
+				if ((c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || c == '_')
+				{
+					classes[c] = char_class::identifier_start | char_class::identifier;
+				}
+				else if (c >= '0' && c <= '9')
+				{
+					classes[c] = char_class::identifier | char_class::digit;
+				}
+			}
+			return classes;
+		}
 
+		constexpr std::array<uint8_t, 256> char_classes = make_char_classes();
+
+	}
+
+	inline auto has_class(const char c, uint8_t mask) -> bool
+	{
+		return (constants::char_classes[static_cast<uint8_t>(c)] & mask) != 0;
 	}
 
 	inline auto is_whitespace(const char c) -> bool
 	{
-		return (' ' == c) || ('\n' == c) ||
-			('\r' == c) || ('\t' == c) ||
-			('\b' == c) || ('\v' == c) ||
-			('\f' == c);
+		return has_class(c, char_class::whitespace);
 	}
 
 	inline auto is_operator_char(const char c) -> bool
@@ -51,7 +81,7 @@ namespace exprcpp::internal
 
 	inline auto is_digit(const char c) -> bool
 	{
-		return ('0' <= c) && (c <= '9');
+		return has_class(c, char_class::digit);
 	}
 
 	inline auto is_letter_or_digit(const char c) -> bool
@@ -81,79 +111,147 @@ namespace exprcpp::internal
 
 	inline auto is_potential_identifier_start(const char& c) -> bool
 	{
-		return (c >= 'a' && c <= 'z')
-			|| (c >= 'A' && c <= 'Z')
-			|| (c == '_')
-			|| (c >= 128);
+		return has_class(c, char_class::identifier_start);
 	}
 
 	inline auto is_potential_identifier_char(const char& c) -> bool
 	{
-		return (c >= 'a' && c <= 'z')
-			|| (c >= 'A' && c <= 'Z')
-			|| (c >= '0' && c <= '9')
-			|| (c == '_')
-			|| (c >= 128);
+		return has_class(c, char_class::identifier);
 	}
 
-	static auto syntax_error(token_ptr_t& token, const std::string& message) -> void
+	// Position of the first character at or after position that is not in the class, sixteen at a time where SSE2 is available
+	inline auto scan_class(const char* data, size_t position, size_t size, uint8_t mask) -> size_t
 	{
-		if (token == nullptr)
+#ifdef EXPRCPP_SSE2
+		for (; position + 16 <= size; position += 16)
 		{
-			token = std::make_shared<token_t>();
+			const __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + position));
+			__m128i in_class = _mm_setzero_si128();
+			if (mask & char_class::whitespace)
+			{ // ' ' and the control characters '\b' through '\r'
+				in_class = _mm_or_si128(in_class, _mm_cmpeq_epi8(chunk, _mm_set1_epi8(' ')));
+				in_class = _mm_or_si128(in_class, _mm_and_si128(_mm_cmpgt_epi8(chunk, _mm_set1_epi8('\b' - 1)), _mm_cmplt_epi8(chunk, _mm_set1_epi8('\r' + 1))));
+			}
+			if (mask & char_class::identifier)
+			{ // Bytes above 127 compare as negative and fall outside every range
+				const __m128i lower = _mm_or_si128(chunk, _mm_set1_epi8(0x20));
+				in_class = _mm_or_si128(in_class, _mm_and_si128(_mm_cmpgt_epi8(lower, _mm_set1_epi8('a' - 1)), _mm_cmplt_epi8(lower, _mm_set1_epi8('z' + 1))));
+				in_class = _mm_or_si128(in_class, _mm_cmpeq_epi8(chunk, _mm_set1_epi8('_')));
+			}
+			if (mask & (char_class::identifier | char_class::digit))
+			{
+				in_class = _mm_or_si128(in_class, _mm_and_si128(_mm_cmpgt_epi8(chunk, _mm_set1_epi8('0' - 1)), _mm_cmplt_epi8(chunk, _mm_set1_epi8('9' + 1))));
+			}
+
+			const unsigned outside = ~static_cast<unsigned>(_mm_movemask_epi8(in_class)) & 0xFFFF;
+			if (outside != 0)
+			{
+#if defined(_MSC_VER)
+				unsigned long index;
+				_BitScanForward(&index, outside);
+				return position + index;
+#else
+				return position + __builtin_ctz(outside);
+#endif
+			}
+		}
+#endif
+		while (position < size && has_class(data[position], mask))
+		{
+			position++;
 		}
-		token->value = message;
-		token->type = TOK_ERRORTOKEN;
+		return position;
 	}
 
-	tokenizer_t::tokenizer_t(const std::string& expression_string)
+	inline auto keyword_type(std::string_view text) -> token_type_e
+	{
+		switch (text.size())
+		{
+		case 2:
+			if (text[0] == 'i')
+			{
+				return text[1] == 'n' ? TOK_IN : text[1] == 'f' ? TOK_IF : TOK_NAME;
+			}
+			return text == "or" ? TOK_OR : TOK_NAME;
+		case 3:
+			return text == "not" ? TOK_NOT : text == "and" ? TOK_AND : TOK_NAME;
+		case 4:
+			return text == "else" ? TOK_ELSE : TOK_NAME;
+		default:
+			return TOK_NAME;
+		}
+	}
+
+	tokenizer_t::tokenizer_t(std::string_view expression_string)
 		: m_expression_string(expression_string)
 	{
 		m_current = m_expression_string.begin();
 	}
 
-	auto tokenizer_t::get() -> token_ptr_t 
+	auto tokenizer_t::reset(std::string_view expression_string) -> void
 	{
-		token_ptr_t token = std::make_shared<token_t>();
-		char c; // skip white spaces    
-		do 
-		{
-			c = next();
-		} while (is_whitespace(c));
+		m_expression_string = expression_string;
+		m_error = nullptr;
+		m_current = m_expression_string.begin();
+		m_done = false;
+		m_first = true;
+	}
 
-		m_start = m_current;
+	auto tokenizer_t::seek(size_t offset) -> void
+	{
+		// The tokenizer rests on the last character it consumed, the next token starts one further
+		m_current = m_expression_string.begin() + (offset > 0 ? offset - 1 : 0);
+		m_done = false;
+		m_first = offset == 0;
+	}
+
+	auto tokenizer_t::text(const token_t& token) const -> std::string_view
+	{
+		return m_expression_string.substr(token.offset, token.length);
+	}
 
-		if (c == EOF)
+	auto tokenizer_t::error() const -> const char*
+	{
+		return m_error;
+	}
+
+	auto tokenizer_t::get() -> token_t
+	{
+		token_t token;
+		const char* data = m_expression_string.data();
+		const size_t size = m_expression_string.size();
+
+		// Whitespace and identifiers are scanned in runs, the rest of the token still goes character by character
+		size_t position = m_done ? size : m_first ? 0 : static_cast<size_t>(m_current - m_expression_string.begin()) + 1;
+		position = scan_class(data, position, size, char_class::whitespace);
+		if (position >= size)
 		{
-			token->value = "";
-			token->type = TOK_ENDMARKER;
+			m_current = m_expression_string.end();
+			m_first = false;
+			token.type = TOK_ENDMARKER;
+			token.offset = static_cast<uint32_t>(size);
 			m_done = true;
 			return token;
 		}
 
+		m_current = m_expression_string.begin() + position;
+		m_first = false;
+		m_start = m_current;
+		char c = data[position];
+
 		if (is_potential_identifier_start(c))
 		{
-			while (is_potential_identifier_char(c))
-			{
-				c = next();
-			}
-			back();
+			m_current = m_expression_string.begin() + (scan_class(data, position + 1, size, char_class::identifier) - 1);
 			m_end = m_current;
-			const auto value = std::string(m_start, m_end + 1);
-			token->value = value;
-			token->type = TOK_NAME;
-			if (constants::keyword_token_pairs.find(value) != constants::keyword_token_pairs.end())
-			{
-				token->type = constants::keyword_token_pairs.at(value);
-			}
+			token = make_token(TOK_NAME);
+			token.type = keyword_type(text(token));
 			return token;
 		}
 
 		if (c == '\n')
 		{
 			m_end = m_current - 1;
-			token->value = "";
-			token->type = TOK_NEWLINE;
+			token = make_token(TOK_NEWLINE);
 			return token;
 		}
 
@@ -188,7 +286,7 @@ namespace exprcpp::internal
 						if (!is_digit(c)) 
 						{
 							back();
-							token->type = TOK_ERRORTOKEN;
+							syntax_error(token, "invalid exponent");
 							return token;
 						}
 					}
@@ -197,9 +295,7 @@ namespace exprcpp::internal
 						back();
 						back();
 						m_end = m_current;
-						token->value = std::string(m_start, m_end + 1);
-						token->type = TOK_NUMBER;
-						return token;
+						return make_token(TOK_NUMBER);
 					}
 					c = decimal_tail(token);
 					if (c == 0) 
@@ -210,35 +306,30 @@ namespace exprcpp::internal
 			}
 			back();
 			m_end = m_current;
-			token->value = std::string(m_start, m_end + 1);
-			token->type = TOK_NUMBER;
-			return token;
+			return make_token(TOK_NUMBER);
 		} 
 		{
 			auto c2 = next();
-			token->type = operator_two_chars(c, c2);
-			if (token->type != TOK_OP)
+			auto type = operator_two_chars(c, c2);
+			if (type != TOK_OP)
 			{
 				auto c3 = next();
-				auto type = operator_three_chars(c, c2, c3);
-				if (type != TOK_OP)
+				auto triple = operator_three_chars(c, c2, c3);
+				if (triple != TOK_OP)
 				{
-					token->type = type;
+					type = triple;
 				}
 				else
 				{
 					back();
 				}
 				m_end = m_current;
-				token->value = std::string(m_start, m_end + 1);
-				return token;
+				return make_token(type);
 			}
 			back();
 		}
 		m_end = m_current;
-		token->value = std::string(m_start, m_end + 1);
-		token->type = operator_one_char(c);
-		return token;
+		return make_token(operator_one_char(c));
 	}
 
 	auto tokenizer_t::next() -> char
@@ -271,21 +362,37 @@ namespace exprcpp::internal
 		--m_current;
 	}
 
-	auto tokenizer_t::back(const std::string::const_iterator& location) -> void
+	auto tokenizer_t::back(const std::string_view::const_iterator& location) -> void
 	{
 		m_current = location;
 	}
 
-	auto tokenizer_t::decimal_tail(token_ptr_t& token) -> char
+	auto tokenizer_t::make_token(token_type_e type) const -> token_t
+	{
+		token_t token;
+		token.type = type;
+		token.offset = static_cast<uint32_t>(m_start - m_expression_string.begin());
+		token.length = static_cast<uint32_t>(m_end + 1 - m_start);
+		return token;
+	}
+
+	auto tokenizer_t::syntax_error(token_t& token, const char* message) -> void
+	{
+		token.type = TOK_ERRORTOKEN;
+		token.offset = static_cast<uint32_t>(m_start - m_expression_string.begin());
+		token.length = static_cast<uint32_t>(m_current - m_start);
+		m_error = message;
+	}
+
+	auto tokenizer_t::decimal_tail(token_t& token) -> char
 	{
 		char c;
 
 		while (true)
 		{
-			do
-			{
-				c = next();
-			} while (is_digit(c));
+			const size_t position = scan_class(m_expression_string.data(), static_cast<size_t>(m_current - m_expression_string.begin()) + 1, m_expression_string.size(), char_class::digit);
+			m_current = m_expression_string.begin() + position;
+			c = position < m_expression_string.size() ? m_expression_string[position] : EOF;
 			if (c != '_')
 			{
 				break;